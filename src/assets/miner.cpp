@@ -7,6 +7,7 @@
  */
 
 #include "../inlcude/assets/miner.h"
+#include "../inlcude/assets/minerstatemachine.h"
 
 using namespace std;
 
@@ -18,6 +19,30 @@ Miner::Miner() : time(0), state(MINING), queueStatus(0), currStation(-1), load(-
     entry();
 }
 
+/**
+ * @brief Constructor initializing a miner with default properties, drawing its first mining cycle from a given stream.
+ * @param rng The miner's random stream.
+ */
+Miner::Miner(const RandomStream &rng) : time(0), state(MINING), queueStatus(0), currStation(-1), load(-1), rng(rng)
+{
+    entry();
+}
+
+/**
+ * @brief Constructor restoring a miner from previously stored properties. No entry logic is run.
+ * @param time Current operation time.
+ * @param miningTime Duration of the last mining cycle.
+ * @param state Current state.
+ * @param queueStatus Current queue status.
+ * @param currStation Current station ID.
+ * @param load Current load percentage.
+ * @param rng The miner's random stream, positioned at its next draw.
+ */
+Miner::Miner(int time, int miningTime, int state, int queueStatus, int currStation, double load, const RandomStream &rng)
+    : time(time), miningTime(miningTime), state(state), queueStatus(queueStatus), currStation(currStation), load(load), rng(rng)
+{
+}
+
 /**
  * @brief Returns the current time for the miner's operation.
  * @return int Current time.
@@ -72,6 +97,15 @@ double Miner::GetLoad() const
     return load;
 }
 
+/**
+ * @brief Returns the miner's random stream.
+ * @return const RandomStream& The stream, its counter tells how many draws were made.
+ */
+const RandomStream &Miner::GetRandom() const
+{
+    return rng;
+}
+
 /**
  * @brief Sets the time for the miner's operation.
  * @param time New operation time.
@@ -125,112 +159,30 @@ void Miner::SetLoad(double load)
     this->load = load;
 }
 
+/**
+ * @brief Fills values with uniform draws in [0, 1) from the miner's stream.
+ * @param values Receives the draws.
+ * @param count Number of draws.
+ */
+void Miner::Draw(double *values, size_t count)
+{
+    rng.Fill(values, count, 0.0, 1.0);
+}
+
 /**
  * @brief Entry logic for the miner's state, handling initial actions based on the current state.
+ * Durations come from the active scenario, see MinerStateMachine.
  */
 void Miner::entry()
 {
-    switch (GetState())
-    {
-    case STATES::MINING:
-        {
-            random_device rd;
-            mt19937 gen(rd());
-            uniform_int_distribution<> distr(12, 60);
-            uniform_real_distribution<double> loadCapacity(0.75, 1.0);
-            SetTime(distr(gen));
-            SetMiningTime();
-            SetLoad(loadCapacity(gen));
-            SetQueueStatus(IDLE);
-        }
-        break;
-    case STATES::SEARCHING:
-        SetTime(0);
-        break;
-    case STATES::RETURN:
-        SetTime(6);
-        break;
-    case STATES::WAITING:
-        SetTime(0);
-        break;
-    case STATES::UNLOADING:
-        SetTime(1);
-        break;
-    };
+    MinerMachine::Entry(*this);
 }
 
 /**
  * @brief Tick logic for the miner, handling state transitions and actions for each tick.
+ * Transitions are looked up in the MinerStateMachine tables.
  */
 void Miner::tick()
 {
-    switch (GetState())
-    {
-        case MINING:
-        {
-            int curTimeReturn = GetTime(); // Unique variable name
-            if (curTimeReturn > 0)
-            {
-                SetTime(curTimeReturn - 1);
-            }
-            else
-            {
-                SetState(SEARCHING);
-                entry();
-            }
-            break;
-        }
-        case SEARCHING:
-        {
-            int qs = GetQueueStatus();
-            if (qs == FRONT)
-            {
-                SetState(RETURN);
-                entry();
-            }
-            else if (qs == QUEUED)
-            {
-                SetState(WAITING);
-                entry();
-            }
-            break;
-        }
-        case RETURN:
-        {
-            int curTimeReturn = GetTime(); // Unique variable name
-            if (curTimeReturn > 0)
-                SetTime(curTimeReturn - 1);
-            else
-            {
-                SetState(UNLOADING);
-                entry();
-            }
-            break;
-        }
-        case WAITING:
-        {
-            int qs = GetQueueStatus();
-            if (qs == READY)
-            {
-                SetState(RETURN);
-                entry();
-            }
-            break;
-        }
-        case UNLOADING:
-        {
-            int curTimeUnloading = GetTime();
-            if (curTimeUnloading > 0)
-            {
-                SetTime(curTimeUnloading - 1);
-                SetQueueStatus(COMPLETE);
-            }
-            else
-            {   
-                SetState(MINING);
-                entry();
-            }
-            break;
-        }
-    };
-}
\ No newline at end of file
+    MinerMachine::Tick(*this);
+}
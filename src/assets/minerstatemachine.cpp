@@ -0,0 +1,53 @@
+/**
+ * @file minerstatemachine.cpp
+ * @brief Scenario validation and the scenario chosen at startup.
+ *
+ * The state machine itself is a set of constant tables in the header. Only the scenario
+ * durations may come from the command line, and they are set once before any miner is created.
+ */
+
+#include "../inlcude/assets/minerstatemachine.h"
+
+using namespace std;
+
+namespace
+{
+    Scenario configured;
+}
+
+/**
+ * @brief Checks that a scenario describes a cycle every miner can complete.
+ * @throws std::invalid_argument if a duration or load is out of range.
+ */
+void Scenario::Validate() const
+{
+    if (miningMin < 0 || miningMax < miningMin)
+        throw invalid_argument("Mining ticks must satisfy 0 <= min <= max");
+    if (returnTicks < 0)
+        throw invalid_argument("Return ticks must not be negative");
+    // The unload completes on its last countdown tick, so it needs at least one
+    if (unloadTicks < 1)
+        throw invalid_argument("Unload ticks must be at least 1");
+    if (loadMin < 0.0 || loadMax < loadMin)
+        throw invalid_argument("Loads must satisfy 0 <= min <= max");
+}
+
+/**
+ * @brief Returns the scenario miners are created and advanced with.
+ * @return const Scenario& The scenario, the compile-time defaults unless Set was called.
+ */
+const Scenario &ConfiguredScenario::Get()
+{
+    return configured;
+}
+
+/**
+ * @brief Replaces the scenario. Call at startup, before any miner is created.
+ * @param scenario The scenario.
+ * @throws std::invalid_argument if the scenario is not valid.
+ */
+void ConfiguredScenario::Set(const Scenario &scenario)
+{
+    scenario.Validate();
+    configured = scenario;
+}
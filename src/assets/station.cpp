@@ -5,6 +5,7 @@
  * The Station class represents a station in the mining simulation. It manages
  * a queue of miners waiting to be processed, providing thread-safe operations
  * to add and remove miners from the queue, check queue status, and manage station IDs.
+ * The queue is lock-free, so miners interacting with a station never block on each other.
  */
 
 #include "../inlcude/assets/station.h"
@@ -14,8 +15,9 @@ using namespace std;
 /**
  * @brief Constructs a Station object with a specific station ID.
  * @param stationID Unique identifier for the station.
+ * @param pool Node pool the station's queue shares with the other stations.
  */
-Station::Station(int stationID) : stationID(stationID) {}
+Station::Station(int stationID, shared_ptr<QueueNodePool> pool) : idQueue(pool), stationID(stationID) {}
 
 /**
  * @brief Adds a miner ID to the station's queue.
@@ -23,7 +25,6 @@ Station::Station(int stationID) : stationID(stationID) {}
  */
 void Station::add(int id)
 {
-    lock_guard<mutex> lock(queueMutex);
     idQueue.push(id);
 }
 
@@ -32,11 +33,8 @@ void Station::add(int id)
  */
 void Station::remove()
 {
-    lock_guard<mutex> lock(queueMutex);
-    if (!idQueue.empty())
-    {
-        idQueue.pop();
-    }
+    int id;
+    idQueue.pop(id);
 }
 
 /**
@@ -45,7 +43,6 @@ void Station::remove()
  */
 bool Station::isEmpty() const
 {
-    lock_guard<mutex> lock(queueMutex);
     return idQueue.empty();
 }
 
@@ -55,19 +52,50 @@ bool Station::isEmpty() const
  */
 size_t Station::size() const
 {
-    lock_guard<mutex> lock(queueMutex);
     return idQueue.size();
 }
 
 /**
  * @brief Checks if a specific miner ID is at the front of the queue.
  * @param id Miner ID to check.
- * @return true If the specified ID is at the front of the queue. False Otherwise.
+ * @return true If the specified ID is at the front of the queue. False Otherwise, or while the front is changing under contention.
  */
 bool Station::isFront(int id) const
 {
-    lock_guard<mutex> lock(queueMutex);
-    return !idQueue.empty() && idQueue.front() == id;
+    int front;
+    return idQueue.peek(front) && front == id;
+}
+
+/**
+ * @brief Gets the miner ID at the front of the queue.
+ * @return int The front miner ID, or -1 if the queue is empty.
+ */
+int Station::front() const
+{
+    int front;
+    return idQueue.peek(front) ? front : -1;
+}
+
+/**
+ * @brief Gets the miner IDs in the queue, front to back. Only consistent while no miner is added or removed.
+ * @return vector<int> The queued miner IDs.
+ */
+vector<int> Station::contents() const
+{
+    vector<int> ids;
+    idQueue.contents(ids);
+    return ids;
+}
+
+/**
+ * @brief Removes every miner ID from the queue.
+ */
+void Station::clear()
+{
+    int id;
+    while (idQueue.pop(id))
+    {
+    }
 }
 
 /**
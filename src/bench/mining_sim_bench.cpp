@@ -0,0 +1,194 @@
+#include <benchmark/benchmark.h>
+#include "../inlcude/utils/tickhandler.h"
+#include <filesystem>
+#include <sstream>
+
+namespace
+{
+    // Fills a handler with samples for the given fleet, the way a run records them
+    void Populate(MetricsHandler &metricsHandler, int miners, int samples)
+    {
+        int metric = metricsHandler.RegisterMetric("DistanceTraveled");
+        int load = metricsHandler.RegisterMetric("LoadCapacityUtilized");
+        for (int id = 0; id < miners; id++)
+        {
+            int asset = metricsHandler.RegisterAsset("Miner-" + std::to_string(id + 1));
+            for (int tick = 0; tick < samples; tick++)
+            {
+                metricsHandler.RecordMetric(asset, metric, 1.0, tick);
+                metricsHandler.RecordMetric(asset, load, 0.75 + (tick % 25) * 0.01, tick);
+            }
+        }
+    }
+
+    // Removes the timestamped files the exports leave in the working directory
+    void RemoveOutputs(const std::string &prefix)
+    {
+        for (const auto &entry : std::filesystem::directory_iterator(std::filesystem::current_path()))
+        {
+            if (entry.path().filename().string().rfind(prefix, 0) == 0)
+                std::filesystem::remove(entry.path());
+        }
+    }
+}
+
+// One miner cycling through its states, a station signal is faked whenever it searches or waits
+static void BM_MinerTick(benchmark::State &state)
+{
+    Miner miner(RandomStream(1, RandomStream::Entity(RandomStream::MINER, 0)));
+    for (auto _ : state)
+    {
+        if (miner.GetState() == Miner::SEARCHING)
+            miner.SetQueueStatus(Miner::FRONT);
+        else if (miner.GetState() == Miner::WAITING)
+            miner.SetQueueStatus(Miner::READY);
+        miner.tick();
+        benchmark::DoNotOptimize(miner);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MinerTick);
+
+// A miner joins the shortest queue and the station it joined serves it, keeping the queues at their initial length
+static void BM_AddToShortestQueue(benchmark::State &state)
+{
+    int stations = static_cast<int>(state.range(0));
+    StationManager stationManager(stations, stations * 4 + 1);
+    for (int id = 0; id < stations * 4; id++)
+        stationManager.AddToShortestQueue(id);
+    int miner = stations * 4;
+    for (auto _ : state)
+    {
+        int station = stationManager.AddToShortestQueue(miner);
+        stationManager.PopStationQueue(station);
+        benchmark::DoNotOptimize(station);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddToShortestQueue)->RangeMultiplier(10)->Range(1, 10000);
+
+static void BM_StationIsFront(benchmark::State &state)
+{
+    Station station(0, std::make_shared<QueueNodePool>(16));
+    for (int id = 0; id < 8; id++)
+        station.add(id);
+    int id = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(station.isFront(id));
+        id = (id + 1) & 7;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StationIsFront);
+
+// Argument: 1 to aggregate as the samples are recorded. Every thread records into its own shard.
+// Kept samples grow with the iterations, so that variant runs a fixed number of them
+static void BM_RecordMetric(benchmark::State &state)
+{
+    static MetricsHandler *metricsHandler;
+    static int metric;
+    static std::vector<int> assets;
+    if (state.thread_index() == 0)
+    {
+        metricsHandler = new MetricsHandler();
+        metricsHandler->SetStreaming(state.range(0) != 0);
+        metric = metricsHandler->RegisterMetric("DistanceTraveled");
+        assets.clear();
+        for (int id = 0; id < 1000; id++)
+            assets.push_back(metricsHandler->RegisterAsset("Miner-" + std::to_string(id + 1)));
+    }
+    int tick = 0;
+    for (auto _ : state)
+    {
+        metricsHandler->RecordMetric(assets[tick % assets.size()], metric, 1.0, tick);
+        tick++;
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0)
+    {
+        delete metricsHandler;
+        metricsHandler = nullptr;
+    }
+}
+BENCHMARK(BM_RecordMetric)->Arg(0)->Iterations(1 << 20)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_RecordMetric)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+// Arguments: samples in the series, reduced in one pass with sums of squares
+static void BM_SummarizeSeries(benchmark::State &state)
+{
+    std::vector<double> values(static_cast<size_t>(state.range(0)));
+    RandomStream rng(1, 0);
+    rng.Fill(values.data(), values.size(), 0.0, 1.0);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(StatsKernel::Summarize(values, true));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SummarizeSeries)->Arg(1 << 10)->Arg(1 << 20);
+
+// Arguments: miners, each with 100 samples of two metrics. Console output goes to a discarded stream
+static void BM_ListAllMetrics(benchmark::State &state)
+{
+    int miners = static_cast<int>(state.range(0));
+    std::ostringstream sink;
+    std::streambuf *console = std::cout.rdbuf(sink.rdbuf());
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        MetricsHandler metricsHandler;
+        metricsHandler.SetOutputFormat(MetricsHandler::COLUMNAR);
+        Populate(metricsHandler, miners, 100);
+        sink.str("");
+        state.ResumeTiming();
+        metricsHandler.ListAllMetrics();
+    }
+    std::cout.rdbuf(console);
+    RemoveOutputs("test_");
+    state.SetItemsProcessed(state.iterations() * miners * 200);
+}
+BENCHMARK(BM_ListAllMetrics)->Arg(100)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+static void BM_SaveMetricsToJson(benchmark::State &state)
+{
+    int miners = static_cast<int>(state.range(0));
+    MetricsHandler metricsHandler;
+    Populate(metricsHandler, miners, 100);
+    std::ostringstream sink;
+    std::streambuf *console = std::cout.rdbuf(sink.rdbuf());
+    for (auto _ : state)
+        metricsHandler.SaveMetricsToJson("bench_metrics.json");
+    std::cout.rdbuf(console);
+    RemoveOutputs("bench_metrics_");
+    state.SetItemsProcessed(state.iterations() * miners * 200);
+}
+BENCHMARK(BM_SaveMetricsToJson)->Arg(100)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+// Arguments: miners, stations and engine. A whole unpaced run of one simulated day on the default pool
+static void BM_Simulation(benchmark::State &state)
+{
+    int miners = static_cast<int>(state.range(0));
+    int stations = static_cast<int>(state.range(1));
+    int horizon = 288;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        MetricsHandler metricsHandler;
+        metricsHandler.SetStreaming(true);
+        MinerManager minerManager(miners, 1);
+        StationManager stationManager(stations, miners);
+        TickHandler tickHandler(minerManager, stationManager, 0, 0, metricsHandler);
+        tickHandler.SetEngine(static_cast<int>(state.range(2)));
+        tickHandler.SetHorizon(horizon);
+        state.ResumeTiming();
+        tickHandler.start();
+        tickHandler.wait();
+    }
+    state.counters["MinerTicks"] = benchmark::Counter(static_cast<double>(state.iterations()) * miners * horizon, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Simulation)
+    ->ArgNames({"miners", "stations", "engine"})
+    ->ArgsProduct({{10, 1000, 100000, 1000000}, {1, 100, 10000}, {TickHandler::TICK, TickHandler::EVENT}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -2,7 +2,7 @@
 #define MINER_H
 
 #include <iostream>
-#include <random>
+#include "../utils/randomstream.h"
 #include <mutex>
 
 class Miner
@@ -27,6 +27,8 @@ class Miner
         };
 
         Miner();
+        explicit Miner(const RandomStream &rng);
+        Miner(int time, int miningTime, int state, int queueStatus, int currStation, double load, const RandomStream &rng = RandomStream());
 
         // Getters
         int GetTime() const;
@@ -35,6 +37,7 @@ class Miner
         int GetQueueStatus() const;
         int GetStationID() const;
         double GetLoad() const;
+        const RandomStream &GetRandom() const;
 
         // Setters
         void SetTime(int time);
@@ -43,6 +46,7 @@ class Miner
         void SetQueueStatus(int queueStatus);
         void SetStation(int id);
         void SetLoad(double load);
+        void Draw(double *values, size_t count);
 
         void tick();
 
@@ -53,6 +57,8 @@ class Miner
         int queueStatus;
         int currStation;
         double load;
+        // The miner's own stream, drawn from when it starts mining
+        RandomStream rng;
         void entry();
 
 };
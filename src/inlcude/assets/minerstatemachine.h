@@ -0,0 +1,179 @@
+#ifndef MINERSTATEMACHINE_H
+#define MINERSTATEMACHINE_H
+
+#include "miner.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// Compile-time defaults of the scenario, override with -D to build a different one in
+#ifndef MINING_TICKS_MIN
+#define MINING_TICKS_MIN 12     //Shortest mining cycle, 1 hour
+#endif
+#ifndef MINING_TICKS_MAX
+#define MINING_TICKS_MAX 60     //Longest mining cycle, 5 hours
+#endif
+#ifndef RETURN_TICKS
+#define RETURN_TICKS 6          //Travel to a station, 30 minutes
+#endif
+#ifndef UNLOAD_TICKS
+#define UNLOAD_TICKS 1          //Time at the station, 5 minutes
+#endif
+
+#define MINER_STATE_COUNT 5     //Number of Miner::STATES
+#define MINER_STATUS_COUNT 5    //Number of Miner::STATUS
+
+// Durations and loads of a scenario, in ticks
+struct Scenario
+{
+    int miningMin = MINING_TICKS_MIN;
+    int miningMax = MINING_TICKS_MAX;
+    int returnTicks = RETURN_TICKS;
+    int unloadTicks = UNLOAD_TICKS;
+    double loadMin = 0.75;
+    double loadMax = 1.0;
+
+    void Validate() const;
+};
+
+// Policy with the scenario fixed at compile time, so every duration folds into the code
+struct FixedScenario
+{
+    static constexpr Scenario Get() { return Scenario{}; }
+};
+
+// Policy with the scenario chosen at startup, before any miner is created
+struct ConfiguredScenario
+{
+    static const Scenario &Get();
+    static void Set(const Scenario &scenario);
+};
+
+#ifdef MINER_FIXED_SCENARIO
+using ActiveScenario = FixedScenario;
+#else
+using ActiveScenario = ConfiguredScenario;
+#endif
+
+/*
+ * The miner's state machine as constant tables. A timed state counts its time down and moves
+ * to its expiry state once the time is used up. An untimed state waits for a station signal,
+ * its queue status, to pick the next state. Every transition runs the new state's entry.
+ */
+template <typename Policy>
+class MinerStateMachine
+{
+public:
+    struct State
+    {
+        bool timed;
+        // Timed states: the state entered once the time is used up
+        int expiry;
+        // Timed states: the queue status set when the countdown ends, -1 for none
+        int completes;
+        // Untimed states: the state entered for each queue status, -1 to stay
+        int onStatus[MINER_STATUS_COUNT];
+    };
+
+    static constexpr State TABLE[MINER_STATE_COUNT] = {
+        /* MINING    */ {true, Miner::SEARCHING, -1, {-1, -1, -1, -1, -1}},
+        /* SEARCHING */ {false, -1, -1, {-1, Miner::RETURN, Miner::WAITING, -1, -1}},
+        /* RETURN    */ {true, Miner::UNLOADING, -1, {-1, -1, -1, -1, -1}},
+        /* WAITING   */ {false, -1, -1, {-1, -1, -1, Miner::RETURN, -1}},
+        /* UNLOADING */ {true, Miner::MINING, Miner::COMPLETE, {-1, -1, -1, -1, -1}},
+    };
+
+    // Bit s is set for every timed state s
+    static constexpr uint32_t TimedStates()
+    {
+        uint32_t bits = 0;
+        for (int state = 0; state < MINER_STATE_COUNT; state++)
+            bits |= TABLE[state].timed ? 1u << state : 0u;
+        return bits;
+    }
+
+    // Bit s is set for every timed state s whose countdown ends with a queue status
+    static constexpr uint32_t CompletingStates()
+    {
+        uint32_t bits = 0;
+        for (int state = 0; state < MINER_STATE_COUNT; state++)
+            bits |= TABLE[state].completes >= 0 ? 1u << state : 0u;
+        return bits;
+    }
+
+    // Bit s * MINER_STATUS_COUNT + q is set when queue status q moves untimed state s on
+    static constexpr uint32_t SignalledPairs()
+    {
+        uint32_t bits = 0;
+        for (int state = 0; state < MINER_STATE_COUNT; state++)
+            for (int status = 0; status < MINER_STATUS_COUNT; status++)
+                bits |= TABLE[state].onStatus[status] >= 0 ? 1u << (state * MINER_STATUS_COUNT + status) : 0u;
+        return bits;
+    }
+
+    static_assert(MINER_STATE_COUNT * MINER_STATUS_COUNT <= 32, "Signal pairs must fit one word");
+
+    static constexpr uint32_t TIMED = TimedStates();
+    static constexpr uint32_t COMPLETING = CompletingStates();
+    static constexpr uint32_t SIGNALLED = SignalledPairs();
+
+    // Sets up a state on entry: its duration and, for MINING, the cycle's length and load
+    static void Entry(Miner &miner)
+    {
+        const Scenario &scenario = Policy::Get();
+        switch (miner.GetState())
+        {
+            case Miner::MINING:
+            {
+                // Both draws come from a single block of the miner's stream
+                double draws[2];
+                miner.Draw(draws, 2);
+                miner.SetTime(scenario.miningMin + static_cast<int>(draws[0] * (scenario.miningMax - scenario.miningMin + 1)));
+                miner.SetMiningTime();
+                miner.SetLoad(scenario.loadMin + (scenario.loadMax - scenario.loadMin) * draws[1]);
+                miner.SetQueueStatus(Miner::IDLE);
+                break;
+            }
+            case Miner::RETURN:
+                miner.SetTime(scenario.returnTicks);
+                break;
+            case Miner::UNLOADING:
+                miner.SetTime(scenario.unloadTicks);
+                break;
+            default:
+                miner.SetTime(0);
+                break;
+        }
+    }
+
+    // Advances a miner by one tick
+    static void Tick(Miner &miner)
+    {
+        const State &state = TABLE[miner.GetState()];
+        int next;
+        if (state.timed)
+        {
+            int time = miner.GetTime();
+            if (time > 0)
+            {
+                miner.SetTime(time - 1);
+                if (time == 1 && state.completes >= 0)
+                    miner.SetQueueStatus(state.completes);
+                return;
+            }
+            next = state.expiry;
+        }
+        else
+        {
+            next = state.onStatus[miner.GetQueueStatus()];
+            if (next < 0)
+                return;
+        }
+        miner.SetState(next);
+        Entry(miner);
+    }
+};
+
+using MinerMachine = MinerStateMachine<ActiveScenario>;
+
+#endif // MINERSTATEMACHINE_H
@@ -1,23 +1,26 @@
 #ifndef STATION_H
 #define STATION_H
 
-#include <mutex>
-#include <queue>
+#include "../utils/lockfreequeue.h"
+#include <memory>
+#include <vector>
 
 class Station
 {
 private:
-    std::queue<int> idQueue;
+    LockFreeQueue idQueue;
     int stationID;
-    mutable std::mutex queueMutex;
 
 public:
-    Station(int stationID);
+    Station(int stationID, std::shared_ptr<QueueNodePool> pool);
     void add(int id);
     void remove();
     bool isEmpty() const;
     size_t size() const;
     bool isFront(int id) const;
+    int front() const;
+    std::vector<int> contents() const;
+    void clear();
     int GetID() const;
     void SetID(int stationID);
 };
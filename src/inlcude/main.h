@@ -2,9 +2,16 @@
 #define MAIN_H
 
 #include "utils/tickhandler.h"
+#include "utils/replicationrunner.h"
+#include "utils/sweeprunner.h"
+#include "utils/metricsserver.h"
+#include "utils/distributedrunner.h"
+#include "utils/eventlog.h"
 #include <cstdlib>
+#include <random>
 
 #define TICK_RATE 10            //Milliseconds. One tick represents 5 minutes
+#define BATCH_TICK_RATE 0       //Unpaced. Ticks advance as fast as the CPU allows
 
 // Base function
 
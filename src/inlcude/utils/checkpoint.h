@@ -0,0 +1,93 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "mappedfile.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#define CHECKPOINT_MAGIC "MSIMCKP1"
+#define CHECKPOINT_VERSION 3
+
+/*
+ * File layout, all integers little-endian. Sections follow the header in a fixed order, each
+ * written by the component it belongs to:
+ *   header   magic[8], version u32, reserved u32
+ *   miners   seed and every fleet column (MinerManager)
+ *   stations queue contents and reservations (StationManager)
+ *   run      next tick, engine, metric sample random streams, event schedule (TickHandler)
+ *   metrics  name registry, merged samples with their ticks or aggregates, raw window and rollups (MetricsHandler)
+ * Arrays are a u64 element count followed by the elements, so they are written and read in bulk.
+ */
+
+// Appends values and arrays to a checkpoint file
+class CheckpointWriter
+{
+public:
+    CheckpointWriter(const std::string &path);
+
+    template <typename T>
+    void Write(const T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Checkpoint values must be trivially copyable");
+        file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void WriteArray(const std::vector<T> &values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Checkpoint values must be trivially copyable");
+        Write<uint64_t>(values.size());
+        file.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    void WriteString(const std::string &text);
+    void Close();
+
+private:
+    std::ofstream file;
+    std::string path;
+};
+
+// Reads a checkpoint file back through a memory mapping, arrays are copied out in one block each
+class CheckpointReader
+{
+public:
+    CheckpointReader(const std::string &path);
+
+    template <typename T>
+    T Read()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Checkpoint values must be trivially copyable");
+        T value;
+        std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void ReadArray(std::vector<T> &values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Checkpoint values must be trivially copyable");
+        uint64_t count = Read<uint64_t>();
+        if (count > (file.GetSize() - offset) / sizeof(T))
+            throw std::runtime_error("Truncated checkpoint");
+        values.resize(static_cast<size_t>(count));
+        if (count > 0)
+            std::memcpy(values.data(), Take(values.size() * sizeof(T)), values.size() * sizeof(T));
+    }
+
+    std::string ReadString();
+    bool AtEnd() const;
+
+private:
+    MappedFile file;
+    size_t offset;
+
+    const char *Take(size_t bytes);
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,115 @@
+#ifndef COLUMNARFILE_H
+#define COLUMNARFILE_H
+
+#include "mappedfile.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#define COLUMNAR_MAGIC "MSIMCOL1"
+#define COLUMNAR_VERSION 1
+#define COLUMNAR_ALIGNMENT 8    //Every column starts on an 8-byte boundary so it can be read in place
+
+/*
+ * File layout, all integers little-endian:
+ *   header       magic[8], version u32, column count u32, string table offset u64, string table size u64
+ *   index        one ColumnEntry per column, sorted by (asset, metric)
+ *   string table asset and metric names, not terminated
+ *   data         one aligned array per column
+ */
+class ColumnarFile
+{
+public:
+    enum ENCODING
+    {
+        F64,        //Exact doubles
+        F32,        //Floats, half the size and lossy
+        DELTA_I32   //Differences between successive integral values, falls back to F64 for columns that are not integral
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t columnCount;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+    };
+
+    struct ColumnEntry
+    {
+        uint32_t assetOffset;
+        uint32_t assetLength;
+        uint32_t metricOffset;
+        uint32_t metricLength;
+        uint32_t encoding;
+        uint32_t reserved;
+        uint64_t count;
+        uint64_t dataOffset;
+    };
+};
+
+class ColumnarWriter
+{
+public:
+    void AddColumn(const std::string &asset, const std::string &metric, const double *values, size_t count, int encoding = ColumnarFile::F64);
+    void Write(const std::string &path) const;
+
+private:
+    // Values are referenced, not copied, and must stay alive until Write
+    struct Column
+    {
+        std::string asset;
+        std::string metric;
+        const double *values;
+        size_t count;
+        int encoding;
+    };
+
+    std::vector<Column> columns;
+
+    static bool IsDeltaEncodable(const double *values, size_t count);
+};
+
+// Zero-copy view of one column inside a mapped file
+class ColumnView
+{
+public:
+    ColumnView(std::string_view asset, std::string_view metric, int encoding, size_t count, const char *data);
+
+    std::string_view GetAsset() const;
+    std::string_view GetMetric() const;
+    int GetEncoding() const;
+    size_t size() const;
+    const double *AsF64() const;
+    const float *AsF32() const;
+    const int32_t *AsDeltas() const;
+    std::vector<double> Decode() const;
+
+private:
+    std::string_view asset;
+    std::string_view metric;
+    int encoding;
+    size_t count;
+    const char *data;
+};
+
+class ColumnarReader
+{
+public:
+    ColumnarReader(const std::string &path);
+
+    size_t GetColumnCount() const;
+    const ColumnView &GetColumn(size_t index) const;
+    const ColumnView *Find(std::string_view asset, std::string_view metric) const;
+
+private:
+    MappedFile file;
+    std::vector<ColumnView> columns;
+};
+
+#endif // COLUMNARFILE_H
@@ -0,0 +1,87 @@
+#ifndef DISTRIBUTEDRUNNER_H
+#define DISTRIBUTEDRUNNER_H
+
+#include "tickhandler.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+
+// Station updates, their outcomes and metric samples cross process boundaries as fixed-size records
+struct DistributedRequest
+{
+    int32_t id;         // Fleet-wide miner ID
+    int32_t station;    // Station being left, -1 to enqueue at the shortest queue
+    double load;        // Load delivered when leaving
+};
+
+struct DistributedResult
+{
+    int32_t id;
+    int32_t station;
+    int32_t queueStatus;
+};
+
+struct DistributedSample
+{
+    int32_t id;
+    int32_t metric;     // One of TickHandler::METRIC
+    double value;
+};
+
+// Lockstep run with the fleet split across worker processes on one machine. The coordinator owns the stations and the
+// metrics, every worker owns a contiguous slice of miners, and each tick costs one batched round trip per worker
+class DistributedRunner
+{
+public:
+    DistributedRunner(int miners, int stations, uint64_t seed, int processes, MetricsHandler &metricsHandler = MetricsHandler::GetInstance());
+    ~DistributedRunner();
+    DistributedRunner(const DistributedRunner &) = delete;
+    DistributedRunner &operator=(const DistributedRunner &) = delete;
+
+    void SetHorizon(int ticks);
+    int GetHorizon() const;
+    void Run();
+
+private:
+    int miners;
+    int processes;
+    uint64_t seed;
+    int horizon;
+    StationManager stationManager;
+    MetricsHandler &metricsHandler;
+    std::vector<RandomStream> stationStreams;
+    int metricIds[TickHandler::METRIC_COUNT];
+    std::vector<int> minerAssets;
+    std::vector<int> stationAssets;
+
+    // One socket and process per worker, in the order of their slices
+    std::vector<intptr_t> sockets;
+    std::vector<long> pids;
+
+    void launch();
+    void reap();
+    void commit(const std::vector<DistributedRequest> &requests, int tick, std::vector<DistributedResult> &results);
+    void readFronts(std::vector<int32_t> &front);
+};
+
+// Worker side of a DistributedRunner, it simulates its slice of the fleet between batched exchanges with the coordinator
+class DistributedWorker
+{
+public:
+    DistributedWorker(intptr_t socket);
+    void Run();
+
+private:
+    intptr_t socket;
+    std::unique_ptr<MinerManager> minerManager;
+    std::vector<RandomStream> minerStreams;
+    std::vector<int32_t> front;
+    std::vector<DistributedRequest> requests;
+    std::vector<DistributedSample> samples;
+    std::vector<DistributedResult> results;
+
+    void decide();
+};
+
+#endif // DISTRIBUTEDRUNNER_H
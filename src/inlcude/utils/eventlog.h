@@ -0,0 +1,112 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include "mappedfile.h"
+#include "metricshandler.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+#include <stdexcept>
+
+#define EVENTLOG_MAGIC "MSIMEVL1"
+#define EVENTLOG_VERSION 1
+#define EVENT_ARENA_EVENTS 65536    //Initial events per arena, an arena only grows if one tick outgrows it
+
+/*
+ * File layout, all integers little-endian:
+ *   header   magic[8], version u32, reserved u32, seed u64, miners i32, stations i32, first tick i32, reserved i32
+ *   streams  miner then station metric stream positions at the first tick, each a u64 count and u64 counters
+ *   events   EventLog::Event records up to the end of the file, appended tick by tick
+ * Every section is a multiple of 8 bytes, so the events of a mapped file are read in place.
+ */
+
+// Append-only binary log of what happened in a run, recorded into per-worker arenas and written out between ticks
+class EventLog
+{
+public:
+    enum TYPE
+    {
+        START_MINING,   // A miner started a mining cycle
+        ENQUEUE,        // A miner joined a station queue
+        FRONT,          // A waiting miner reached the front of its queue
+        UNLOAD,         // A miner finished unloading and left its station
+        EVENT_TYPE_COUNT
+    };
+
+    struct Event
+    {
+        int32_t tick;
+        int32_t miner;
+        int32_t station;    // -1 away from stations
+        int32_t type;
+        int32_t cycle;      // Mining ticks of the miner's current cycle
+        int32_t queue;      // Queue length at the station, counting the miner
+        double load;        // Load of the miner's current cycle
+    };
+
+    EventLog(const std::string &path, unsigned int arenas, size_t capacity = EVENT_ARENA_EVENTS);
+    ~EventLog();
+    EventLog(const EventLog &) = delete;
+    EventLog &operator=(const EventLog &) = delete;
+
+    void Begin(uint64_t seed, int firstTick, const std::vector<uint64_t> &minerCounters, const std::vector<uint64_t> &stationCounters);
+    void Flush();
+    void Close();
+    unsigned int GetArenas() const;
+    uint64_t GetCount() const;
+
+    // A few stores into the worker's own arena, it only allocates while a tick outgrows the arena
+    void Record(unsigned int arena, const Event &event)
+    {
+        Arena &target = *arenas[arena];
+        if (target.count == target.events.size())
+            target.events.resize(target.events.size() * 2);
+        target.events[target.count++] = event;
+    }
+
+private:
+    // Aligned so neighbouring workers never write to the same cache line
+    struct alignas(64) Arena
+    {
+        std::vector<Event> events;
+        size_t count = 0;
+    };
+
+    std::ofstream file;
+    std::string path;
+    std::vector<std::unique_ptr<Arena>> arenas;
+    uint64_t written;
+};
+
+// Reads an event log through a memory mapping, the events are used in place
+class EventLogReader
+{
+public:
+    EventLogReader(const std::string &path);
+
+    uint64_t GetSeed() const;
+    int GetMiners() const;
+    int GetStations() const;
+    int GetFirstTick() const;
+    size_t GetCount() const;
+    const EventLog::Event *begin() const;
+    const EventLog::Event *end() const;
+
+    // Recomputes the metrics the simulation records, as recorded by a run without a log
+    void Replay(MetricsHandler &metricsHandler) const;
+
+private:
+    MappedFile file;
+    uint64_t seed;
+    int miners;
+    int stations;
+    int firstTick;
+    std::vector<uint64_t> minerCounters;
+    std::vector<uint64_t> stationCounters;
+    const EventLog::Event *events;
+    size_t count;
+};
+
+#endif // EVENTLOG_H
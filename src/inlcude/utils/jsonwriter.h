@@ -0,0 +1,38 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+#define JSON_BUFFER_SIZE 65536  //Bytes collected before each write to the file
+
+// Writes JSON text straight to a file through a fixed buffer, no document is built in memory
+class JsonWriter
+{
+public:
+    JsonWriter(const std::string &path);
+    ~JsonWriter();
+    JsonWriter(const JsonWriter &) = delete;
+    JsonWriter &operator=(const JsonWriter &) = delete;
+
+    bool IsOpen() const;
+    void Raw(std::string_view text);
+    void Indent(int depth);
+    void String(std::string_view text);
+    void Number(double value);
+    void Integer(long long value);
+    void Unsigned(unsigned long long value);
+    bool Flush();
+
+private:
+    std::ofstream file;
+    std::vector<char> buffer;
+    size_t used;
+
+    char *Reserve(size_t bytes);
+};
+
+#endif // JSONWRITER_H
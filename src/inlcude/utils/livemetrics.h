@@ -0,0 +1,40 @@
+#ifndef LIVEMETRICS_H
+#define LIVEMETRICS_H
+
+#include "stationmanager.h"
+#include "../assets/minerstatemachine.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+// Counters of a run in progress, updated with relaxed atomics and read by the metrics server at any time
+class LiveMetrics
+{
+public:
+    LiveMetrics(int stations);
+
+    void Begin(int tick);
+    void SetTick(int tick);
+    void RecordUnload(int station);
+    bool SnapshotRequested() const;
+    void Publish(const int *states, int miners, StationManager &stationManager);
+    std::string Render();
+
+private:
+    std::atomic<int> tick;
+    std::atomic<int> firstTick;
+    std::atomic<int64_t> startTime;
+    std::atomic<uint64_t> unloads;
+    std::unique_ptr<std::atomic<uint64_t>[]> stationUnloads;
+    int stations;
+
+    // Published between ticks by the timer thread, only after a scrape asked for a fresh snapshot
+    std::atomic<bool> requested;
+    std::atomic<int> snapshotTick;
+    std::atomic<int> minersByState[MINER_STATE_COUNT];
+    std::unique_ptr<std::atomic<uint64_t>[]> queueDepth;
+};
+
+#endif // LIVEMETRICS_H
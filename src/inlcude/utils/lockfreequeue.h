@@ -0,0 +1,60 @@
+#ifndef LOCKFREEQUEUE_H
+#define LOCKFREEQUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// Node references pack a 32-bit node index with a 32-bit modification tag so a recycled node never satisfies a stale CAS
+#define QUEUE_NIL 0xFFFFFFFFu
+#define PEEK_ATTEMPTS 4         //Bound on peek retries while the front keeps changing, keeps peeks wait-free
+
+class QueueNodePool
+{
+public:
+    struct Node
+    {
+        std::atomic<int> value;
+        std::atomic<uint64_t> next;
+    };
+
+    QueueNodePool(size_t capacity);
+    QueueNodePool(const QueueNodePool &) = delete;
+    QueueNodePool &operator=(const QueueNodePool &) = delete;
+
+    uint32_t acquire();
+    void release(uint32_t index);
+    Node &operator[](uint32_t index);
+    size_t GetCapacity() const;
+
+private:
+    std::unique_ptr<Node[]> nodes;
+    size_t capacity;
+    std::atomic<uint64_t> freeHead;
+};
+
+class LockFreeQueue
+{
+public:
+    LockFreeQueue(std::shared_ptr<QueueNodePool> pool);
+    ~LockFreeQueue();
+    LockFreeQueue(const LockFreeQueue &) = delete;
+    LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+
+    void push(int value);
+    bool pop(int &value);
+    bool peek(int &value) const;
+    size_t size() const;
+    bool empty() const;
+    void contents(std::vector<int> &values) const;
+
+private:
+    std::shared_ptr<QueueNodePool> pool;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+    std::atomic<size_t> count;
+};
+
+#endif // LOCKFREEQUEUE_H
@@ -0,0 +1,29 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+#include <stdexcept>
+
+// Read-only memory mapping of a whole file, pages are faulted in as they are touched
+class MappedFile
+{
+public:
+    MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *GetData() const;
+    size_t GetSize() const;
+
+private:
+    const char *data;
+    size_t size;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,68 @@
+#ifndef METRICSFLUSHER_H
+#define METRICSFLUSHER_H
+
+#include "metricshandler.h"
+#include "jsonwriter.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#define METRICS_FLUSH_TICKS 12      //Ticks between flushes, an hour of 5-minute ticks
+
+// Appends a run's samples to a file from a background thread while the run goes on. Between ticks the samples merged so
+// far are swapped into one buffer while the writer thread writes out the other, so at most two intervals of samples
+// are held in memory and whatever was flushed survives a killed run
+class MetricsFlusher
+{
+public:
+    enum FORMAT
+    {
+        NDJSON,     // One {"asset","metric","tick","value"} object per line
+        CSV         // Asset,Metric,Tick,Value rows
+    };
+
+    MetricsFlusher(const std::string &path, int format = NDJSON, int interval = METRICS_FLUSH_TICKS, MetricsHandler &metricsHandler = MetricsHandler::GetInstance());
+    ~MetricsFlusher();
+    MetricsFlusher(const MetricsFlusher &) = delete;
+    MetricsFlusher &operator=(const MetricsFlusher &) = delete;
+
+    void Flush();
+    void Sync();
+    void Close();
+    int GetInterval() const;
+    uint64_t GetWritten() const;
+
+private:
+    MetricsHandler &metricsHandler;
+    JsonWriter out;
+    std::string path;
+    int format;
+    int interval;
+
+    // Filled by Flush while the writer thread writes out the other buffer
+    std::vector<MetricsHandler::Record> front;
+    std::vector<MetricsHandler::Record> back;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool pending;
+    bool writing;
+    bool closing;
+    bool failed;
+    std::atomic<uint64_t> written;
+    std::thread writer;
+
+    // Names by ID, only touched by the writer thread
+    std::vector<std::string> assetNames;
+    std::vector<std::string> metricNames;
+
+    void run();
+    void write(const std::vector<MetricsHandler::Record> &samples);
+    const std::string &name(std::vector<std::string> &names, int id, bool asset);
+};
+
+#endif // METRICSFLUSHER_H
@@ -1,10 +1,10 @@
 #ifndef METRICSHANDLER_H
 #define METRICSHANDLER_H
 
-#include <nlohmann/json.hpp>
 #include <fstream>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <iostream>
 #include <algorithm>
@@ -14,21 +14,157 @@
 #include <ctime>
 #include <iomanip>
 #include <tuple>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <utility>
+#include <cstdint>
+#include "streamingstats.h"
+#include "statskernel.h"
+#include "rollupstore.h"
+#include "checkpoint.h"
+#include "columnarfile.h"
+#include "jsonwriter.h"
+#include "workerpool.h"
+#include <filesystem>
 
 class MetricsHandler
 {
     public:
+        enum FORMAT
+        {
+            JSON,
+            COLUMNAR,
+            JSON_SHARDED
+        };
+
         static MetricsHandler &GetInstance();
+        MetricsHandler();
         MetricsHandler(const MetricsHandler &) = delete;
         MetricsHandler &operator=(const MetricsHandler &) = delete;
         std::map<std::string, std::vector<double>> GetMetrics(const std::string &category) const;
+
+        // Read-only view of a series' samples and the ticks they were recorded at, ordered by tick. It points into the
+        // merged store, so it stays valid until samples recorded after it was taken are merged by the next query
+        class SeriesView
+        {
+            public:
+                SeriesView() = default;
+                SeriesView(const double *values, const int *ticks, size_t count);
+                const double *begin() const { return values; }
+                const double *end() const { return values + count; }
+                double operator[](size_t index) const { return values[index]; }
+                int GetTick(size_t index) const { return ticks[index]; }
+                const int *GetTicks() const { return ticks; }
+                size_t size() const { return count; }
+                bool empty() const { return count == 0; }
+                SeriesView Between(int fromTick, int toTick) const;
+
+            private:
+                const double *values = nullptr;
+                const int *ticks = nullptr;
+                size_t count = 0;
+        };
+        SeriesView GetSeries(int asset, int metric) const;
+        SeriesView GetSeries(const std::string &category, const std::string &metricName) const;
+        SeriesView GetSeries(const std::string &category, const std::string &metricName, int fromTick, int toTick) const;
+        std::map<std::string, StreamingStats> GetAggregates(const std::string &category) const;
+        std::map<std::string, StreamingStats> GetAggregatesByMetric() const;
+        static std::string TimestampedPath(const std::string &filename);
         void ListAllMetrics();
         void SaveMetricsToJson(const std::string &filename) const;
-        void RecordMetric(const std::string &category, const std::string &metricName, double value);
+        void SaveMetricsToJsonShards(const std::string &filename, unsigned int workers = 0) const;
+        void SaveMetricsToColumnar(const std::string &filename, int encoding = ColumnarFile::F64) const;
+        void SaveRollupsToCsv(const std::string &filename) const;
+        void SetOutputFormat(int format, int encoding = ColumnarFile::F64);
+        void RecordMetric(const std::string &category, const std::string &metricName, double value, int tick = -1);
+        void RecordMetric(int asset, int metric, double value, int tick = -1);
+
+        // Name registry, resolving asset (category) and metric names to dense IDs once
+        int RegisterAsset(const std::string &name);
+        int RegisterMetric(const std::string &name);
+        std::string GetAssetName(int asset) const;
+        std::string GetMetricName(int metric) const;
+
+        // Streaming mode keeps bounded running aggregates per series instead of every sample
+        void SetStreaming(bool enabled);
+        bool IsStreaming() const;
+
+        // Rollups bucket every series by tick at a few widths, and a raw window keeps only the latest ticks' samples
+        void SetRollups(const std::vector<int> &widths, int rawWindow = -1);
+        std::vector<int> GetRollupWidths() const;
+        int GetRawWindow() const;
+        std::vector<RollupBucket> GetRollup(const std::string &category, const std::string &metricName, int width) const;
+        void Compact();
+
+        void SaveCheckpoint(CheckpointWriter &out) const;
+        void RestoreCheckpoint(CheckpointReader &in);
+
+        // A sample as recorded, tagged with its series and the tick it was recorded at
+        struct Record
+        {
+            int asset;
+            int metric;
+            int tick;
+            double value;
+        };
+
+        // Draining hands merged records to Drain instead of keeping them, so a writer can move them out during the run
+        void SetDraining(bool enabled);
+        void Drain(std::vector<Record> &samples);
 
     private :
-        MetricsHandler() = default;
-        std::map<std::string, std::map<std::string, std::vector<double>>> metrics;
+        // Records appended by one thread, each tagged with the tick it was recorded at
+        struct Shard
+        {
+            std::mutex mtx;
+            std::vector<Record> records;
+            // Streaming mode only, aggregates keyed by SeriesKey(asset, metric)
+            std::unordered_map<uint64_t, StreamingStats> aggregates;
+        };
+
+        Shard &LocalShard();
+        void Merge() const;
+        std::vector<int> SortedByName(const std::vector<std::string> &names) const;
+        bool HasSeries(int asset, int metric) const;
+        bool HasSamples(int asset, int metric) const;
+        void TrimRaw(int latest) const;
+        static void MergeByTick(std::vector<double> &values, std::vector<int> &valueTicks, size_t middle);
+        static uint64_t SeriesKey(int asset, int metric);
+        void SummarizeAsset(int asset, const std::vector<int> &metricOrder, std::string &listing, std::vector<std::pair<std::string, double>> &figures, std::vector<double> &scratch) const;
+        bool WriteAssetJson(JsonWriter &out, int asset, const std::vector<int> &metricOrder, int depth, const char *separator) const;
+
+        unsigned long long serial;
+        std::atomic<bool> streaming;
+        std::atomic<bool> rolling;
+        std::atomic<bool> draining;
+        int rawWindow;
+        int outputFormat;
+        int outputEncoding;
+        mutable std::mutex shardsMtx;
+        std::vector<std::unique_ptr<Shard>> shards;
+        // Each recording thread's shard, looked up when the thread's cache holds another handler
+        std::unordered_map<std::thread::id, Shard *> threadShards;
+
+        mutable std::mutex registryMtx;
+        std::unordered_map<std::string, int> assetIds;
+        std::unordered_map<std::string, int> metricIds;
+        std::vector<std::string> assetNames;
+        std::vector<std::string> metricNames;
+
+        // Merged samples as a flat [asset][metric] table
+        mutable std::vector<std::vector<std::vector<double>>> metrics;
+        // Tick each merged sample was recorded at, same layout as metrics
+        mutable std::vector<std::vector<std::vector<int>>> ticks;
+        // Merged streaming aggregates, same [asset][metric] layout, also kept under a raw window so the summary covers every sample
+        mutable std::vector<std::vector<StreamingStats>> aggregates;
+        // Rollups of the merged samples, built as samples are merged
+        mutable RollupStore rollups;
+        // Records merged while draining, waiting for the next Drain
+        mutable std::vector<Record> drained;
+        // Summary figures of each asset from the last ListAllMetrics, sorted by name, exported but never recorded as samples
+        std::vector<std::vector<std::pair<std::string, double>>> summaries;
 };
 
 #endif // METRICSHANDLER_H
@@ -0,0 +1,39 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include "livemetrics.h"
+#include <thread>
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+#define SERVER_POLL_MS 200      //How often the listener checks whether it should stop
+#define SERVER_READ_MS 2000     //How long a client may take to send its request line before it is dropped
+#define SERVER_REQUEST_BYTES 8192   //Longest request line read, longer requests are dropped
+
+// Minimal HTTP listener on the loopback interface serving LiveMetrics at /metrics
+class MetricsServer
+{
+public:
+    MetricsServer(LiveMetrics &liveMetrics, unsigned short port);
+    ~MetricsServer();
+    MetricsServer(const MetricsServer &) = delete;
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+    void Start();
+    void Stop();
+    unsigned short GetPort() const;
+
+private:
+    LiveMetrics &liveMetrics;
+    unsigned short port;
+    intptr_t listener;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    void serve();
+    void respond(intptr_t client);
+};
+
+#endif // METRICSSERVER_H
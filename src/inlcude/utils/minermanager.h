@@ -2,19 +2,53 @@
 #define MINER_MANAGER_H
 
 #include "../assets/miner.h"
-#include <map>
+#include "../assets/minerstatemachine.h"
+#include "checkpoint.h"
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
 #include <utility>
+#include <cstdint>
+
+#define KERNEL_BLOCK 256        //Miners per batch kernel pass. Sized so the per-block transition flags stay on the stack
 
 class MinerManager
 {
     public:
-        MinerManager(int assets);
-        Miner& GetMiner(int id);
+        MinerManager(int assets, uint64_t seed = 0, int first = 0);
+        Miner GetMiner(int id) const;
+        void SetMiner(int id, const Miner &miner);
         int GetAssets();
+        int GetFirst() const;
+        uint64_t GetSeed() const;
+
+        // Per-miner field access without materializing a Miner
+        const int *GetStates() const;
+        int GetQueueStatus(int id) const;
+        int GetStationID(int id) const;
+        void SetQueueStatus(int id, int queueStatus);
+        void SetStation(int id, int station);
+
+        void TickBlock(int begin, int end);
+
+        void SaveCheckpoint(CheckpointWriter &out) const;
+        void RestoreCheckpoint(CheckpointReader &in);
 
     private:
-        std::map<int, Miner> miners;
+        // Structure-of-arrays fleet store, every column indexed directly by miner id
+        std::vector<int> state;
+        std::vector<int> time;
+        std::vector<int> miningTime;
+        std::vector<int> queueStatus;
+        std::vector<int> station;
+        std::vector<double> load;
+        // Draws made so far from each miner's random stream
+        std::vector<uint64_t> draws;
         int assets;
+        int first;
+        uint64_t seed;
+
+        void CheckID(int id) const;
 };
 
 #endif // MINER_MANAGER_H
@@ -0,0 +1,42 @@
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <cstdint>
+#include <cstddef>
+
+#define PHILOX_ROUNDS 10
+
+// Counter-based random numbers (Philox4x32-10). Every draw is a pure function of (seed, entity, counter),
+// so independent streams need no shared state and a stream is saved and restored as a single counter
+class RandomStream
+{
+public:
+    // Entity namespaces, keeping the streams of different kinds of entity with the same ID apart
+    enum KIND
+    {
+        MINER = 1,
+        MINER_METRICS = 2,
+        STATION_METRICS = 3
+    };
+
+    RandomStream(uint64_t seed = 0, uint64_t entity = 0, uint64_t counter = 0);
+    static uint64_t Entity(int kind, int id);
+
+    double Uniform(double low, double high);
+    int UniformInt(int low, int high);
+    void Fill(double *out, size_t count, double low, double high);
+
+    uint64_t GetSeed() const;
+    uint64_t GetEntity() const;
+    uint64_t GetCounter() const;
+    void SetCounter(uint64_t counter);
+
+private:
+    uint64_t seed;
+    uint64_t entity;
+    uint64_t counter;
+
+    void block(uint32_t out[4]);
+};
+
+#endif // RANDOMSTREAM_H
@@ -0,0 +1,53 @@
+#ifndef REPLICATIONRUNNER_H
+#define REPLICATIONRUNNER_H
+
+#include "simulation.h"
+#include "streamingstats.h"
+#include "jsonwriter.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+class ReplicationRunner
+{
+public:
+    // Across-replication mean and 95% confidence interval of one outcome, e.g. the fleet's total DistanceTraveled
+    struct Summary
+    {
+        std::string name;
+        size_t replications;
+        double mean;
+        double stddev;
+        double low;
+        double high;
+    };
+
+    ReplicationRunner(int miners, int stations, int replications, uint64_t seed, unsigned int workers = 0);
+    void SetEngine(int engine);
+    void SetHorizon(int ticks);
+    void Run();
+    const std::vector<Summary> &GetSummaries() const;
+    void ListSummaries() const;
+    void SaveSummariesToJson(const std::string &filename) const;
+
+    static double StudentT(size_t degrees);
+
+private:
+    int miners;
+    int stations;
+    int replications;
+    uint64_t seed;
+    unsigned int workers;
+    int engine;
+    int horizon;
+
+    // Outcomes of each replication by name, indexed by replication
+    std::vector<std::map<std::string, double>> outcomes;
+    std::vector<Summary> summaries;
+
+    std::map<std::string, double> runReplication(int replication) const;
+    void summarize();
+};
+
+#endif // REPLICATIONRUNNER_H
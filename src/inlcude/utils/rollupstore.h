@@ -0,0 +1,51 @@
+#ifndef ROLLUPSTORE_H
+#define ROLLUPSTORE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+class CheckpointWriter;
+class CheckpointReader;
+
+#define ROLLUP_HOUR_TICKS 12        //5-minute ticks per hour
+#define ROLLUP_DAY_TICKS 288        //5-minute ticks per day
+
+// Count, sum, min and max of the samples a series recorded over one bucket of ticks
+struct RollupBucket
+{
+    int32_t start;      // First tick of the bucket, a multiple of its width
+    int32_t reserved;
+    uint64_t count;
+    double sum;
+    double min;
+    double max;
+
+    double Mean() const { return count ? sum / static_cast<double>(count) : 0.0; }
+};
+
+// Per-series rollups over fixed-width tick buckets, at several widths at once. Memory grows with the simulated time
+// divided by the width, not with the number of samples
+class RollupStore
+{
+public:
+    RollupStore();
+
+    void SetWidths(const std::vector<int> &widths);
+    const std::vector<int> &GetWidths() const;
+    bool IsEnabled() const;
+    void Add(int asset, int metric, int tick, double value);
+    const std::vector<RollupBucket> &GetBuckets(int asset, int metric, size_t level) const;
+    size_t GetBucketCount() const;
+    void Clear();
+    void SaveCheckpoint(CheckpointWriter &out) const;
+    void RestoreCheckpoint(CheckpointReader &in);
+
+private:
+    std::vector<int> widths;
+    // [asset][metric][level] buckets, ordered by start tick and only present once a sample fell into them
+    std::vector<std::vector<std::vector<std::vector<RollupBucket>>>> series;
+};
+
+#endif // ROLLUPSTORE_H
@@ -0,0 +1,25 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "tickhandler.h"
+#include <cstdint>
+
+// One self-contained, unpaced run on the calling thread. Simulations share no state, so many can run side by side
+class Simulation
+{
+public:
+    Simulation(int miners, int stations, uint64_t seed);
+    void SetEngine(int engine);
+    void SetHorizon(int ticks);
+    void Run();
+    MetricsHandler &GetMetrics();
+
+private:
+    // Declared first, the tick handler records into it
+    MetricsHandler metricsHandler;
+    MinerManager minerManager;
+    StationManager stationManager;
+    TickHandler tickHandler;
+};
+
+#endif // SIMULATION_H
@@ -2,6 +2,7 @@
 #define STATIONMANAGER_H
 
 #include "../assets/station.h"
+#include "checkpoint.h"
 #include <vector>
 #include <mutex>
 #include <algorithm>
@@ -9,21 +10,38 @@
 #include <utility>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <stdexcept>
 
 class StationManager
 {
 public:
-    StationManager(int assets);
+    StationManager(int assets, int miners);
     std::shared_ptr<Station> GetStation(int id);
     size_t GetStationSize(int id);
     int AddToShortestQueue(int id);
     void PopStationQueue(int id);
     int GetAssets() const;
 
+    void SaveCheckpoint(CheckpointWriter &out);
+    void RestoreCheckpoint(CheckpointReader &in);
+
 private:
     int assets;
     std::vector <std::shared_ptr < Station >> stations;
+    std::shared_ptr<QueueNodePool> queueNodes;
     std::mutex stationsMtx;
+
+    // Station-load index: a binary min-heap of station indices keyed by (reserved queue length, index), guarded by stationsMtx
+    std::vector<int> loadHeap;
+    std::vector<int> heapPosition;
+    std::vector<size_t> reserved;
+
+    int IndexOf(int id) const;
+    bool LessLoaded(int a, int b) const;
+    void SiftUp(int pos);
+    void SiftDown(int pos);
+    void SwapHeap(int a, int b);
 };
 
 #endif // STATIONMANAGER_H
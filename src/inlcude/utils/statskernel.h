@@ -0,0 +1,38 @@
+#ifndef STATSKERNEL_H
+#define STATSKERNEL_H
+
+#include <vector>
+#include <cstddef>
+
+#define STATS_LANES 8           //Independent accumulators per pass, enough to fill the widest vector registers with doubles
+
+// Everything the summaries need from a series, gathered in a single pass
+struct SeriesSummary
+{
+    size_t count;
+    double sum;
+    double sumSquares;      // Only gathered on request, 0 otherwise
+    double min;
+    double max;
+    // Samples above zero, for series where zero means no sample
+    size_t positiveCount;
+    double positiveSum;
+
+    double Mean() const;
+    double Variance() const;
+};
+
+// Reduction kernels over series of samples, branch-free loops the compiler turns into SIMD code
+class StatsKernel
+{
+public:
+    static SeriesSummary Summarize(const double *values, size_t count, bool squares = false);
+    static SeriesSummary Summarize(const std::vector<double> &values, bool squares = false);
+
+    // Percentiles by selection, the values are reordered. Quantiles are ascending, a percentile is the smallest value
+    // whose rank reaches q times the count, the rule StreamingStats::Quantile estimates
+    static double Percentile(std::vector<double> &values, double q);
+    static void Percentiles(std::vector<double> &values, const double *quantiles, double *results, size_t count);
+};
+
+#endif // STATSKERNEL_H
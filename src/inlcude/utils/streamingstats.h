@@ -0,0 +1,66 @@
+#ifndef STREAMINGSTATS_H
+#define STREAMINGSTATS_H
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+
+class CheckpointWriter;
+class CheckpointReader;
+
+#define SKETCH_K 200            //KLL accuracy parameter. Rank error is roughly 1.7 / SKETCH_K
+
+class QuantileSketch
+{
+public:
+    QuantileSketch(int k = SKETCH_K);
+    void Add(double value);
+    void Merge(const QuantileSketch &other);
+    double Quantile(double q) const;
+    size_t GetCount() const;
+    size_t GetRetained() const;
+    void SaveCheckpoint(CheckpointWriter &out) const;
+    void RestoreCheckpoint(CheckpointReader &in);
+
+private:
+    int k;
+    size_t count;
+    unsigned int compactions;
+    // Level h holds items that each stand for 2^h samples
+    std::vector<std::vector<double>> levels;
+
+    size_t Capacity(size_t level) const;
+    void Compress();
+};
+
+class StreamingStats
+{
+public:
+    StreamingStats();
+    void Add(double value);
+    void Merge(const StreamingStats &other);
+
+    size_t GetCount() const;
+    double GetSum() const;
+    double GetMin() const;
+    double GetMax() const;
+    double GetMean() const;
+    double GetVariance() const;
+    double Quantile(double q) const;
+    void SaveCheckpoint(CheckpointWriter &out) const;
+    void RestoreCheckpoint(CheckpointReader &in);
+
+private:
+    size_t count;
+    double sum;
+    double min;
+    double max;
+    // Welford running mean and sum of squared deviations
+    double mean;
+    double m2;
+    QuantileSketch sketch;
+};
+
+#endif // STREAMINGSTATS_H
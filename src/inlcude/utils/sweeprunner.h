@@ -0,0 +1,53 @@
+#ifndef SWEEPRUNNER_H
+#define SWEEPRUNNER_H
+
+#include "simulation.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class SweepRunner
+{
+public:
+    // Key outcomes of one configuration of the grid
+    struct Result
+    {
+        int miners;
+        int stations;
+        int horizon;
+        size_t unloads;
+        double unloadsPerHour;
+        double materialVolume;
+        double avgQueue;
+        double p90Queue;
+        double maxQueue;
+        double stationUtilization;
+        // Why the configuration failed, empty if it ran
+        std::string error;
+    };
+
+    SweepRunner(const std::vector<int> &miners, const std::vector<int> &stations, const std::vector<int> &horizons,
+                uint64_t seed, unsigned int workers = 0);
+    void SetEngine(int engine);
+    void Run();
+    const std::vector<Result> &GetResults() const;
+    void ListResults() const;
+    void SaveResultsToCsv(const std::string &filename) const;
+
+    static std::vector<int> ParseRange(const std::string &spec);
+
+private:
+    std::vector<int> miners;
+    std::vector<int> stations;
+    std::vector<int> horizons;
+    uint64_t seed;
+    unsigned int workers;
+    int engine;
+
+    // One result per configuration, miners-major, then stations, then horizon
+    std::vector<Result> results;
+
+    Result runConfiguration(int miners, int stations, int horizon) const;
+};
+
+#endif // SWEEPRUNNER_H
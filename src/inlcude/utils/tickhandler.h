@@ -6,30 +6,138 @@
 #include "metricshandler.h"
 #include "minermanager.h"
 #include "stationmanager.h"
+#include "workerpool.h"
+#include "timingwheel.h"
+#include "randomstream.h"
+#include "checkpoint.h"
+#include "tickprofiler.h"
+#include "livemetrics.h"
+#include "eventlog.h"
+#include "metricsflusher.h"
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <exception>
 #include <vector>
+#include <string>
 #include <iostream>
+#include <memory>
 
-#define MAX_TICK 864
+#define MAX_TICK 864            //Default horizon, 72 hours of 5-minute ticks
 
 class TickHandler
 {
 public:
-    TickHandler(MinerManager &minerManager, StationManager &stationManager, unsigned int interval_ms);
+    enum ENGINE
+    {
+        TICK,       // Every miner is visited on every tick
+        EVENT,      // Only miners whose scheduled transition fires are visited
+        LOCKSTEP    // Every miner is visited on every tick in decide and commit phases, reproducible at any worker count
+    };
+
+    // Metrics recorded by a run, indexed by GetMetricName
+    enum METRIC
+    {
+        DISTANCE_TRAVELED,
+        LOAD_CAPACITY_UTILIZED,
+        FUEL_CONSUMPTION,
+        MINING_TIME,
+        QUEUE_TIMES,
+        MATERIAL_VOLUME,
+        MATERIAL_QUALITY,
+        UTILIZATION_RATE,
+        METRIC_COUNT
+    };
+    static const char *GetMetricName(int metric);
+
+    TickHandler(MinerManager &minerManager, StationManager &stationManager, unsigned int interval_ms, unsigned int workers = 0,
+                MetricsHandler &metricsHandler = MetricsHandler::GetInstance());
     ~TickHandler();
     void start();
     void stop();
+    void wait();
+    bool isRunning() const;
+    void SetEngine(int engine);
+    void SetHorizon(int ticks);
+    int GetHorizon() const;
+    int GetTick() const;
+
+    // Per-phase timing of every tick, off unless enabled
+    void EnableProfiling(bool enabled);
+    TickProfiler *GetProfiler() const;
+
+    // Counters exposed while the run is in progress, none by default
+    void SetLiveMetrics(LiveMetrics *liveMetrics);
+
+    // Records events in place of metric samples while attached, none by default
+    void SetEventLog(EventLog *eventLog);
+    unsigned int GetWorkers() const;
+
+    // Samples are handed to the flusher every interval and once the run ends, none by default
+    void SetMetricsFlusher(MetricsFlusher *metricsFlusher);
+
+    // Checkpoints are taken between ticks, or while the simulation is not running
+    void SetCheckpoint(int tick, const std::string &path);
+    void SaveCheckpoint(const std::string &path);
+    void RestoreCheckpoint(const std::string &path);
 
 private:
     MinerManager &minerManager;
     StationManager &stationManager;
+    MetricsHandler &metricsHandler;
     unsigned int interval_ms_;
-    std::vector<std::thread> timerThreads_;
+    WorkerPool pool_;
+    std::thread timerThread_;
+    // What the run threw on the timer thread, rethrown by wait()
+    std::exception_ptr failure_;
     std::atomic<bool> keepRunning_;
+    std::atomic<bool> running_;
+    int engine_;
+    int horizon_;
+    int currentTick_;
+    // Next tick to simulate, a restored run resumes from it
+    int nextTick_;
+    int checkpointTick_;
+    std::string checkpointPath_;
+    std::unique_ptr<TickProfiler> profiler_;
+    LiveMetrics *live_;
+    EventLog *log_;
+    MetricsFlusher *flusher_;
+
+    // Metric and asset IDs registered once with the MetricsHandler
+    int metricIds_[METRIC_COUNT];
+    std::vector<int> minerAssets_;
+    std::vector<int> stationAssets_;
+
+    // Streams for metric samples, keyed by the miner manager's seed. Each is only drawn from by the worker handling its entity
+    std::vector<RandomStream> minerStreams_;
+    std::vector<RandomStream> stationStreams_;
+
+    // Event engine state
+    TimingWheel wheel_;
+    std::vector<int> scheduled_;
+    std::vector<int> due_;
+    std::vector<int> commits_;
+
+    // Lockstep engine state, the station updates requested by each chunk of miners during the decide phase.
+    // The tick engine notes each chunk's unloads here while an event log is attached
+    std::vector<std::vector<int>> requests_;
 
-    void tick(int id);
+    void registerMetrics();
+    void run();
+    void checkpoint();
+    void tick(int begin, int end, unsigned int worker, std::vector<int> &unloaded);
+    void tickEvents(int tick);
+    void catchUp();
+    void tickLockstep(int assets, int grain);
+    void decideBlock(int begin, int end, unsigned int worker, std::vector<int> &requests);
+    void schedule(int id, int tick);
+    void decide(int id, std::vector<int> &commits, unsigned int worker);
+    void commit(int id, int tick);
+    void enqueue(int id, unsigned int worker);
+    int dequeue(int id, const Miner &miner, unsigned int worker);
+    void logBegin();
+    void logMiningStart(int id, unsigned int worker);
     void MinierMetrics(Miner &miner, int id);
     void StationMetrics(Station &station, int id, double load);
 };
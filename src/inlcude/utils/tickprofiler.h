@@ -0,0 +1,71 @@
+#ifndef TICKPROFILER_H
+#define TICKPROFILER_H
+
+#include "jsonwriter.h"
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+#define TRACE_EVENT_LIMIT 4000000   //Events kept for the trace across all threads, totals keep counting past it
+
+// Times the phases of every tick per worker thread and keeps them as trace events
+class TickProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum PHASE
+    {
+        TICK,       // The work of a whole tick, on the timer thread
+        STATIONS,   // Station interactions of a chunk of miners, including the metrics they record
+        MINERS,     // State transitions of a chunk of miners
+        METRICS,    // Metrics recording, part of STATIONS
+        SLEEP,      // Pacing, the rest of a tick's interval
+        PHASE_COUNT
+    };
+
+    TickProfiler(unsigned int threads);
+    void Record(unsigned int thread, int phase, int tick, Clock::time_point begin, Clock::time_point end, int64_t detail = 0);
+    void RecordTick(int tick, Clock::time_point begin, Clock::time_point end, Clock::time_point scheduled, unsigned int interval_ms);
+    uint64_t GetCount(int phase) const;
+    int64_t GetTotal(int phase) const;
+    uint64_t GetOverruns() const;
+    void ListSummary() const;
+    void SaveTrace(const std::string &filename) const;
+
+    // Time spent recording metrics by the calling thread, folded into its next STATIONS event
+    static thread_local int64_t metricsTime;
+
+private:
+    struct Event
+    {
+        int64_t begin;
+        int64_t duration;
+        // Metrics time of a STATIONS event, drift of a TICK event, in nanoseconds
+        int64_t detail;
+        int32_t tick;
+        int32_t phase;
+    };
+
+    // Written only by its own thread, padded so neighbouring threads do not share cache lines
+    struct alignas(64) ThreadLog
+    {
+        std::vector<Event> events;
+        int64_t total[PHASE_COUNT] = {};
+        int64_t longest[PHASE_COUNT] = {};
+        uint64_t count[PHASE_COUNT] = {};
+    };
+
+    Clock::time_point origin;
+    size_t eventLimit;
+    std::vector<ThreadLog> logs;
+
+    // Pacing of the timer thread
+    uint64_t overruns;
+    int64_t longestOverrun;
+    int64_t drift;
+};
+
+#endif // TICKPROFILER_H
@@ -0,0 +1,25 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#define WHEEL_SLOTS 256         //Ticks covered by one rotation of the wheel. Must be a power of two
+
+class TimingWheel
+{
+public:
+    TimingWheel();
+    void schedule(int tick, int id);
+    void popDue(int tick, std::vector<int> &due);
+    size_t size() const;
+    void clear();
+
+private:
+    // Each slot holds (tick, id) entries. Entries further out than one rotation wait in their slot for later rotations
+    std::vector<std::vector<std::pair<int, int>>> slots;
+    size_t entries;
+};
+
+#endif // TIMINGWHEEL_H
@@ -0,0 +1,53 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <utility>
+
+class WorkerPool
+{
+public:
+    // Called with the chunk range [begin, end) and the index of the worker executing it
+    using Task = std::function<void(int begin, int end, unsigned int worker)>;
+
+    WorkerPool(unsigned int workers = 0);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    void parallelFor(int begin, int end, int grain, const Task &task);
+    unsigned int GetWorkers() const;
+
+private:
+    struct ChunkQueue
+    {
+        std::deque<std::pair<int, int>> chunks;
+        std::mutex mtx;
+    };
+
+    unsigned int workers;
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<ChunkQueue>> queues;
+    const Task *task;
+    std::atomic<int> pending;
+
+    std::mutex poolMtx;
+    std::condition_variable wakeCv;
+    std::condition_variable doneCv;
+    unsigned long long generation;
+    bool shutdown;
+
+    void workerLoop(unsigned int worker);
+    void drain(unsigned int worker);
+    bool popLocal(unsigned int worker, std::pair<int, int> &chunk);
+    bool steal(unsigned int worker, std::pair<int, int> &chunk);
+};
+
+#endif // WORKERPOOL_H
@@ -4,38 +4,446 @@ using namespace std;
 
 int main(int argc, char *argv[])
 {
+    // Replaying an event log recomputes a finished run's metrics without simulating it again
+    if (argc == 3 && string(argv[1]) == "--replay")
+    {
+        try
+        {
+            auto start = chrono::steady_clock::now();
+            EventLogReader reader(argv[2]);
+            reader.Replay(MetricsHandler::GetInstance());
+            auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "Replayed " << reader.GetCount() << " events of " << reader.GetMiners() << " miners and " << reader.GetStations()
+                 << " stations (seed " << reader.GetSeed() << ") in " << elapsed * 1000.0 << " ms" << endl;
+
+            // A metric the simulation never records: ticks from joining a queue to leaving the station
+            vector<int> joined(reader.GetMiners(), -1);
+            double turnaround = 0.0;
+            size_t unloads = 0;
+            for (const auto &event : reader)
+            {
+                if ((event.type == EventLog::ENQUEUE || event.type == EventLog::UNLOAD) && (event.miner < 0 || event.miner >= reader.GetMiners()))
+                    throw runtime_error("Corrupt event log");
+                if (event.type == EventLog::ENQUEUE)
+                    joined[event.miner] = event.tick;
+                else if (event.type == EventLog::UNLOAD && joined[event.miner] >= 0)
+                {
+                    turnaround += event.tick - joined[event.miner];
+                    unloads++;
+                }
+            }
+            cout << "Average station turnaround: " << (unloads > 0 ? turnaround / unloads : 0.0) << " ticks over " << unloads << " unloads" << endl;
+        }
+        catch (const runtime_error &e)
+        {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        MetricsHandler::GetInstance().ListAllMetrics();
+        return 0;
+    }
+
     if (argc < 3)
     {
-        std::cerr << "Usage: " << argv[0] << " <number_of_miners> <number_of_stations>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <number_of_miners> <number_of_stations> [--batch] [--threads <n>] [--engine tick|event|lockstep] [--processes <n>] [--seed <n>] [--replications <n>] [--sweep] [--horizon <ticks>] [--checkpoint <file>] [--checkpoint-at <tick>] [--restore <file>] [--event-log <file>] [--profile] [--serve <port>] [--mining-ticks <min>:<max>] [--return-ticks <n>] [--unload-ticks <n>] [--streaming] [--rollup <ticks>[,<ticks>...]] [--raw-window <ticks>] [--flush <file>] [--format json|json-sharded|columnar] [--encoding f64|f32|delta]" << std::endl;
+        std::cerr << "       " << argv[0] << " --replay <event_log>" << std::endl;
         return 1;
     }
 
     int numberOfMiners = std::atoi(argv[1]);
     int numberOfStations = std::atoi(argv[2]);
 
-    MinerManager mm(numberOfMiners);
-    StationManager sm(numberOfStations);
+    // Batch mode advances simulated time as fast as possible instead of pacing every tick against the wall clock
+    bool batch = false;
+    // Worker threads processing the fleet, 0 sizes the pool to the hardware
+    unsigned int threads = 0;
+    // The event engine only visits miners whose transitions fire instead of every miner on every tick
+    int engine = TickHandler::TICK;
+    bool engineSet = false;
+    // Worker processes sharing a lockstep run, each simulating a slice of the fleet, 0 runs in this process
+    int processes = 0;
+    // Streaming keeps running aggregates per metric instead of every sample, memory no longer grows with the run
+    bool streaming = false;
+    // Rollups bucket every metric by simulated time, e.g. 12,288 for hourly and daily, and a raw window keeps only the latest ticks' samples
+    string rollupSpec;
+    int rawWindow = -1;
+    // Flushing appends samples to a CSV or NDJSON file in the background during the run instead of holding them until the end
+    string flushPath;
+    // Independent replications run side by side and are summarized with confidence intervals instead of one run
+    int replications = 0;
+    // A sweep reads the miner and station arguments as lists or ranges, e.g. 10:100:10 or 5,10,20, and runs every combination
+    bool sweep = false;
+    string horizonSpec = to_string(MAX_TICK);
+    // A checkpoint snapshots the whole run at a tick, by default the horizon, and --restore resumes from one
+    string checkpointPath;
+    int checkpointTick = -1;
+    string restorePath;
+    // An event log records what happens to miners and stations in place of metric samples, --replay recomputes the metrics from it
+    string eventLogPath;
+    // Profiling times every phase of every tick and saves a Chrome trace of the run
+    bool profile = false;
+    // Serves live Prometheus counters on 127.0.0.1 while the run is in progress, 0 leaves the server off
+    int servePort = 0;
+    // Scenario durations in ticks, the compile-time defaults unless given
+    Scenario scenario = ConfiguredScenario::Get();
+    // Master seed of every random stream, the same seed reproduces a run
+    uint64_t seed = (static_cast<uint64_t>(random_device{}()) << 32) | random_device{}();
+    // Columnar output stores each series as a typed array that readers map instead of parsing
+    int format = MetricsHandler::JSON;
+    int encoding = ColumnarFile::F64;
+    for (int i = 3; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--batch")
+            batch = true;
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = static_cast<unsigned int>(std::atoi(argv[++i]));
+        else if (arg == "--engine" && i + 1 < argc)
+        {
+            string name = argv[++i];
+            engine = name == "event" ? TickHandler::EVENT : name == "lockstep" ? TickHandler::LOCKSTEP : TickHandler::TICK;
+            engineSet = true;
+        }
+        else if (arg == "--processes" && i + 1 < argc)
+            processes = std::atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--replications" && i + 1 < argc)
+            replications = std::atoi(argv[++i]);
+        else if (arg == "--sweep")
+            sweep = true;
+        else if (arg == "--horizon" && i + 1 < argc)
+            horizonSpec = argv[++i];
+        else if (arg == "--checkpoint" && i + 1 < argc)
+            checkpointPath = argv[++i];
+        else if (arg == "--checkpoint-at" && i + 1 < argc)
+            checkpointTick = std::atoi(argv[++i]);
+        else if (arg == "--restore" && i + 1 < argc)
+            restorePath = argv[++i];
+        else if (arg == "--event-log" && i + 1 < argc)
+            eventLogPath = argv[++i];
+        else if (arg == "--profile")
+            profile = true;
+        else if (arg == "--serve" && i + 1 < argc)
+            servePort = std::atoi(argv[++i]);
+        else if (arg == "--mining-ticks" && i + 1 < argc)
+        {
+            string range = argv[++i];
+            size_t colon = range.find(':');
+            scenario.miningMin = std::atoi(range.c_str());
+            scenario.miningMax = colon == string::npos ? scenario.miningMin : std::atoi(range.c_str() + colon + 1);
+        }
+        else if (arg == "--return-ticks" && i + 1 < argc)
+            scenario.returnTicks = std::atoi(argv[++i]);
+        else if (arg == "--unload-ticks" && i + 1 < argc)
+            scenario.unloadTicks = std::atoi(argv[++i]);
+        else if (arg == "--streaming")
+            streaming = true;
+        else if (arg == "--rollup" && i + 1 < argc)
+            rollupSpec = argv[++i];
+        else if (arg == "--raw-window" && i + 1 < argc)
+            rawWindow = std::atoi(argv[++i]);
+        else if (arg == "--flush" && i + 1 < argc)
+            flushPath = argv[++i];
+        else if (arg == "--format" && i + 1 < argc)
+        {
+            string name = argv[++i];
+            format = name == "columnar" ? MetricsHandler::COLUMNAR : name == "json-sharded" ? MetricsHandler::JSON_SHARDED : MetricsHandler::JSON;
+        }
+        else if (arg == "--encoding" && i + 1 < argc)
+        {
+            string name = argv[++i];
+            encoding = name == "f32" ? ColumnarFile::F32 : name == "delta" ? ColumnarFile::DELTA_I32 : ColumnarFile::F64;
+        }
+    }
+
+    try
+    {
+        ConfiguredScenario::Set(scenario);
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    // Columnar files hold samples, streamed and flushed runs only keep aggregates
+    if (format == MetricsHandler::COLUMNAR && (streaming || !flushPath.empty()))
+    {
+        cerr << "--format columnar needs the samples, it cannot be combined with --streaming or --flush" << endl;
+        return 1;
+    }
+
+    // Sweeps, replications and worker processes keep the metrics of their runs to themselves
+    if (!flushPath.empty() && (sweep || replications > 0 || processes > 0))
+    {
+        cerr << "--flush writes out a single run, it cannot be combined with --sweep, --replications or --processes" << endl;
+        return 1;
+    }
+
+    // Worker processes only simulate and send back their samples, none of the single-process run's extras apply
+    if (processes > 0 && (streaming || profile || !checkpointPath.empty() || checkpointTick >= 0 || !restorePath.empty() || servePort > 0 ||
+                          !eventLogPath.empty() || !rollupSpec.empty() || rawWindow >= 0))
+    {
+        cerr << "--processes cannot be combined with --streaming, --profile, --checkpoint, --restore, --serve, --event-log, --rollup or --raw-window" << endl;
+        return 1;
+    }
+
+    MetricsHandler::GetInstance().SetStreaming(streaming);
+    try
+    {
+        MetricsHandler::GetInstance().SetRollups(rollupSpec.empty() ? vector<int>() : SweepRunner::ParseRange(rollupSpec), rawWindow);
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    MetricsHandler::GetInstance().SetOutputFormat(format, encoding);
+
+    cout << "Seed: " << seed << endl;
+
+    if (sweep)
+    {
+        vector<int> miners, stations, horizons;
+        try
+        {
+            miners = SweepRunner::ParseRange(argv[1]);
+            stations = SweepRunner::ParseRange(argv[2]);
+            horizons = SweepRunner::ParseRange(horizonSpec);
+        }
+        catch (const invalid_argument &e)
+        {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        // Every configuration of the grid has to be runnable, miners always need a station to unload at
+        if (*min_element(miners.begin(), miners.end()) < 0 || *min_element(stations.begin(), stations.end()) < 1 ||
+            *min_element(horizons.begin(), horizons.end()) < 0)
+        {
+            cerr << "Every sweep configuration needs at least 0 miners, 1 station and a horizon of at least 0 ticks" << endl;
+            return 1;
+        }
+        SweepRunner runner(miners, stations, horizons, seed, threads);
+        runner.SetEngine(engine);
+        auto start = chrono::steady_clock::now();
+        runner.Run();
+        auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Ran " << runner.GetResults().size() << " configurations in " << elapsed * 1000.0 << " ms" << endl;
+        runner.ListResults();
+        runner.SaveResultsToCsv("sweep.csv");
+        return 0;
+    }
+
+    // Outside a sweep the horizon is a single tick count
+    vector<int> horizons;
+    try
+    {
+        horizons = SweepRunner::ParseRange(horizonSpec);
+    }
+    catch (const invalid_argument &)
+    {
+    }
+    if (horizons.size() != 1 || horizons[0] < 0)
+    {
+        cerr << "Invalid horizon: " << horizonSpec << ", ranges need --sweep" << endl;
+        return 1;
+    }
+    int horizon = horizons[0];
+    // Miners always need a station to unload at
+    if (numberOfStations < 1)
+    {
+        cerr << "At least one station is needed" << endl;
+        return 1;
+    }
+
+    if (replications > 0)
+    {
+        ReplicationRunner runner(numberOfMiners, numberOfStations, replications, seed, threads);
+        runner.SetEngine(engine);
+        runner.SetHorizon(horizon);
+        auto start = chrono::steady_clock::now();
+        runner.Run();
+        auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Ran " << replications << " replications in " << elapsed * 1000.0 << " ms" << endl;
+        runner.ListSummaries();
+        runner.SaveSummariesToJson("replications.json");
+        return 0;
+    }
+
+    if (processes > 0)
+    {
+        auto start = chrono::steady_clock::now();
+        try
+        {
+            DistributedRunner runner(numberOfMiners, numberOfStations, seed, processes);
+            runner.SetHorizon(horizon);
+            runner.Run();
+        }
+        catch (const exception &e)
+        {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Simulated " << horizon << " ticks on " << min(processes, numberOfMiners) << " worker processes in " << elapsed * 1000.0 << " ms ("
+             << (elapsed > 0 ? static_cast<double>(horizon) * numberOfMiners / elapsed : 0.0) << " miner-ticks/s)" << endl;
+        MetricsHandler::GetInstance().ListAllMetrics();
+        return 0;
+    }
+
+    MinerManager mm(numberOfMiners, seed);
+    StationManager sm(numberOfStations, numberOfMiners);
 
     // Create a TickHandler instance to manage the Miner's ticks
-    TickHandler tickHandler(mm, sm, TICK_RATE); // Trigger every 10 milliseconds
+    TickHandler tickHandler(mm, sm, batch ? BATCH_TICK_RATE : TICK_RATE, threads); // Trigger every 10 milliseconds, or unpaced in batch mode
+    tickHandler.SetEngine(engine);
+    tickHandler.SetHorizon(horizon);
+    tickHandler.EnableProfiling(profile);
+
+    LiveMetrics liveMetrics(numberOfStations);
+    unique_ptr<MetricsServer> server;
+    if (servePort > 0)
+    {
+        try
+        {
+            server = make_unique<MetricsServer>(liveMetrics, static_cast<unsigned short>(servePort));
+        }
+        catch (const runtime_error &e)
+        {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        tickHandler.SetLiveMetrics(&liveMetrics);
+        server->Start();
+        cout << "Serving live metrics at http://127.0.0.1:" << server->GetPort() << "/metrics" << endl;
+    }
+    if (!restorePath.empty())
+    {
+        auto restoreStart = chrono::steady_clock::now();
+        try
+        {
+            tickHandler.RestoreCheckpoint(restorePath);
+        }
+        catch (const runtime_error &e)
+        {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        // A restored run carries on with the checkpoint's engine unless --engine picks another
+        if (engineSet)
+            tickHandler.SetEngine(engine);
+        auto restoreElapsed = chrono::duration<double>(chrono::steady_clock::now() - restoreStart).count();
+        cout << "Restored tick " << tickHandler.GetTick() << " (seed " << mm.GetSeed() << ") from " << restorePath << " in " << restoreElapsed * 1000.0 << " ms" << endl;
+        // A flushed run only summarizes aggregates, the samples a checkpoint kept would be left out
+        if (!flushPath.empty() && !MetricsHandler::GetInstance().IsStreaming())
+        {
+            cerr << "--flush needs a checkpoint saved with --streaming or --flush" << endl;
+            return 1;
+        }
+    }
+    unique_ptr<EventLog> eventLog;
+    if (!eventLogPath.empty())
+    {
+        try
+        {
+            eventLog = make_unique<EventLog>(eventLogPath, tickHandler.GetWorkers());
+        }
+        catch (const runtime_error &e)
+        {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        tickHandler.SetEventLog(eventLog.get());
+    }
+    unique_ptr<MetricsFlusher> flusher;
+    if (!flushPath.empty())
+    {
+        bool csv = flushPath.size() >= 4 && flushPath.compare(flushPath.size() - 4, 4, ".csv") == 0;
+        try
+        {
+            flusher = make_unique<MetricsFlusher>(flushPath, csv ? MetricsFlusher::CSV : MetricsFlusher::NDJSON);
+        }
+        catch (const runtime_error &e)
+        {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        tickHandler.SetMetricsFlusher(flusher.get());
+    }
+    if (!checkpointPath.empty())
+        tickHandler.SetCheckpoint(checkpointTick >= 0 ? checkpointTick : horizon, checkpointPath);
+    int firstTick = tickHandler.GetTick();
+
+    auto start = chrono::steady_clock::now();
 
     // Start the TickHandler
     tickHandler.start();
 
-    cout << "Building Simulation";
-    for (int i = 0; i < 10; ++i)
-    { // Loop for a certain number of iterations
-        cout << ".";
-        if (i % 3 == 2)
-        {                                   
-            cout << "\b\b\b   \b\b\b";
+    if (batch)
+    {
+        tickHandler.wait();
+    }
+    else
+    {
+        cout << "Building Simulation";
+        for (int i = 0; tickHandler.isRunning(); ++i)
+        { // Loop until every miner reaches the horizon, printing a dot every second
+            this_thread::sleep_for(chrono::milliseconds(100));
+            if (i % 10 != 9)
+                continue;
+            cout << "." << flush;
+            if (i % 30 == 29)
+            {
+                cout << "\b\b\b   \b\b\b";
+            }
         }
-        this_thread::sleep_for(chrono::seconds(1));
+        cout << endl;
     }
-    cout << endl;
 
     tickHandler.stop();
 
+    auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    int ticks = tickHandler.GetTick() - firstTick;
+    cout << "Simulated " << ticks << " ticks in " << elapsed * 1000.0 << " ms ("
+         << (elapsed > 0 ? ticks / elapsed : 0.0) << " ticks/s, "
+         << (elapsed > 0 ? static_cast<double>(ticks) * numberOfMiners / elapsed : 0.0) << " miner-ticks/s)" << endl;
+
+    if (TickProfiler *profiler = tickHandler.GetProfiler())
+    {
+        profiler->ListSummary();
+        profiler->SaveTrace("trace.json");
+    }
+
+    if (eventLog)
+    {
+        try
+        {
+            eventLog->Close();
+        }
+        catch (const runtime_error &e)
+        {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        cout << "Logged " << eventLog->GetCount() << " events to " << eventLogPath << ", replay them with --replay " << eventLogPath << endl;
+        return 0;
+    }
+
+    if (flusher)
+    {
+        try
+        {
+            flusher->Close();
+        }
+        catch (const runtime_error &e)
+        {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        cout << "Flushed " << flusher->GetWritten() << " samples to " << flushPath << " during the run" << endl;
+    }
+
     MetricsHandler::GetInstance().ListAllMetrics();
 
     return 0;
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/tickhandler.h"
+#include <filesystem>
+
+namespace
+{
+    // Collects every miner's fields and every series' samples, the whole observable outcome of a run
+    std::vector<double> Outcome(MinerManager &minerManager, MetricsHandler &metricsHandler)
+    {
+        std::vector<double> outcome;
+        for (int id = 0; id < minerManager.GetAssets(); id++)
+        {
+            Miner miner = minerManager.GetMiner(id);
+            outcome.insert(outcome.end(), {static_cast<double>(miner.GetState()), static_cast<double>(miner.GetTime()),
+                                           static_cast<double>(miner.GetStationID()), miner.GetLoad()});
+            for (const auto &[name, samples] : metricsHandler.GetMetrics("Miner-" + std::to_string(id + 1)))
+                outcome.insert(outcome.end(), samples.begin(), samples.end());
+        }
+        for (int id = 0; id < 4; id++)
+        {
+            for (const auto &[name, samples] : metricsHandler.GetMetrics("Station-" + std::to_string(id + 1)))
+                outcome.insert(outcome.end(), samples.begin(), samples.end());
+        }
+        return outcome;
+    }
+}
+
+TEST(CheckpointTest, TestResumedRunMatchesUninterruptedRun)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "mining_sim_checkpoint_test.msck").string();
+    for (int engine : {TickHandler::TICK, TickHandler::EVENT})
+    {
+        MetricsHandler straightMetrics;
+        MinerManager straightMiners(40, 5);
+        StationManager straightStations(4, 40);
+        TickHandler straight(straightMiners, straightStations, 0, 1, straightMetrics);
+        straight.SetEngine(engine);
+        straight.SetHorizon(200);
+        straight.start();
+        straight.wait();
+
+        {
+            MetricsHandler firstMetrics;
+            MinerManager firstMiners(40, 5);
+            StationManager firstStations(4, 40);
+            TickHandler first(firstMiners, firstStations, 0, 1, firstMetrics);
+            first.SetEngine(engine);
+            first.SetHorizon(200);
+            // Taken mid-run, the run carries on to the horizon
+            first.SetCheckpoint(90, path);
+            first.start();
+            first.wait();
+            EXPECT_EQ(Outcome(firstMiners, firstMetrics), Outcome(straightMiners, straightMetrics));
+        }
+
+        MetricsHandler resumedMetrics;
+        MinerManager resumedMiners(40, 99);
+        StationManager resumedStations(4, 40);
+        TickHandler resumed(resumedMiners, resumedStations, 0, 1, resumedMetrics);
+        resumed.SetHorizon(200);
+        resumed.RestoreCheckpoint(path);
+        EXPECT_EQ(resumed.GetTick(), 90);
+        EXPECT_EQ(resumedMiners.GetSeed(), 5u);
+        resumed.start();
+        resumed.wait();
+        EXPECT_EQ(Outcome(resumedMiners, resumedMetrics), Outcome(straightMiners, straightMetrics));
+    }
+
+    MinerManager otherMiners(41, 5);
+    StationManager otherStations(4, 41);
+    MetricsHandler otherMetrics;
+    TickHandler other(otherMiners, otherStations, 0, 1, otherMetrics);
+    EXPECT_THROW(other.RestoreCheckpoint(path), std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST(CheckpointTest, TestResumedRunCanSwitchEngine)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "mining_sim_engine_switch_test.msck").string();
+    // The event and lockstep engines agree tick for tick, so a run may switch between them at a checkpoint
+    for (auto [saved, resumedWith] : {std::pair<int, int>{TickHandler::EVENT, TickHandler::LOCKSTEP}, {TickHandler::LOCKSTEP, TickHandler::EVENT}})
+    {
+        MetricsHandler straightMetrics;
+        MinerManager straightMiners(40, 5);
+        StationManager straightStations(4, 40);
+        TickHandler straight(straightMiners, straightStations, 0, 1, straightMetrics);
+        straight.SetEngine(saved);
+        straight.SetHorizon(200);
+        straight.start();
+        straight.wait();
+
+        {
+            MetricsHandler firstMetrics;
+            MinerManager firstMiners(40, 5);
+            StationManager firstStations(4, 40);
+            TickHandler first(firstMiners, firstStations, 0, 1, firstMetrics);
+            first.SetEngine(saved);
+            first.SetHorizon(90);
+            first.SetCheckpoint(90, path);
+            first.start();
+            first.wait();
+        }
+
+        MetricsHandler resumedMetrics;
+        MinerManager resumedMiners(40, 99);
+        StationManager resumedStations(4, 40);
+        TickHandler resumed(resumedMiners, resumedStations, 0, 1, resumedMetrics);
+        resumed.SetHorizon(200);
+        resumed.RestoreCheckpoint(path);
+        resumed.SetEngine(resumedWith);
+        resumed.start();
+        resumed.wait();
+        EXPECT_EQ(Outcome(resumedMiners, resumedMetrics), Outcome(straightMiners, straightMetrics)) << saved << " resumed with " << resumedWith;
+    }
+    std::filesystem::remove(path);
+}
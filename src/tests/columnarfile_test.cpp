@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/columnarfile.h"
+#include <cstdio>
+#include <vector>
+
+class ColumnarFileTest : public ::testing::Test
+{
+    public:
+        std::string path = "columnarfile_test.msc";
+
+        void TearDown() override
+        {
+            std::remove(path.c_str());
+        }
+};
+
+TEST_F(ColumnarFileTest, TestColumnsRoundTripInEveryEncoding)
+{
+    std::vector<double> ticks = {12, 30, 31, 80, 79, 864};
+    std::vector<double> loads = {0.75, 0.9125, 1.0, 0.8};
+    ColumnarWriter writer;
+    writer.AddColumn("Station-2", "MaterialVolume", loads.data(), loads.size(), ColumnarFile::F32);
+    writer.AddColumn("Miner-1", "MiningTime", ticks.data(), ticks.size(), ColumnarFile::DELTA_I32);
+    writer.AddColumn("Miner-1", "LoadCapacityUtilized", loads.data(), loads.size(), ColumnarFile::F64);
+    // Not integral, stored exactly instead
+    writer.AddColumn("Miner-2", "LoadCapacityUtilized", loads.data(), loads.size(), ColumnarFile::DELTA_I32);
+    writer.Write(path);
+
+    ColumnarReader reader(path);
+    ASSERT_EQ(reader.GetColumnCount(), 4u);
+    EXPECT_EQ(reader.GetColumn(0).GetAsset(), "Miner-1");
+    EXPECT_EQ(reader.GetColumn(0).GetMetric(), "LoadCapacityUtilized");
+
+    const ColumnView *exact = reader.Find("Miner-1", "LoadCapacityUtilized");
+    ASSERT_NE(exact, nullptr);
+    ASSERT_NE(exact->AsF64(), nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(exact->AsF64()) % alignof(double), 0u);
+    EXPECT_EQ(std::vector<double>(exact->AsF64(), exact->AsF64() + exact->size()), loads);
+
+    const ColumnView *deltas = reader.Find("Miner-1", "MiningTime");
+    ASSERT_NE(deltas, nullptr);
+    EXPECT_EQ(deltas->GetEncoding(), ColumnarFile::DELTA_I32);
+    EXPECT_EQ(deltas->Decode(), ticks);
+
+    const ColumnView *fallback = reader.Find("Miner-2", "LoadCapacityUtilized");
+    ASSERT_NE(fallback, nullptr);
+    EXPECT_EQ(fallback->GetEncoding(), ColumnarFile::F64);
+
+    const ColumnView *floats = reader.Find("Station-2", "MaterialVolume");
+    ASSERT_NE(floats, nullptr);
+    ASSERT_NE(floats->AsF32(), nullptr);
+    for (size_t i = 0; i < loads.size(); i++)
+        EXPECT_FLOAT_EQ(floats->AsF32()[i], static_cast<float>(loads[i]));
+
+    EXPECT_EQ(reader.Find("Miner-3", "MiningTime"), nullptr);
+}
+
+TEST_F(ColumnarFileTest, TestRejectsFilesThatAreNotColumnar)
+{
+    FILE *file = std::fopen(path.c_str(), "wb");
+    std::fputs("{\"Miner-1\": {}}", file);
+    std::fclose(file);
+    EXPECT_THROW(ColumnarReader reader(path), std::runtime_error);
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/distributedrunner.h"
+
+namespace
+{
+    // Collects every series' samples, miners first, then stations
+    std::vector<double> Samples(MetricsHandler &metricsHandler, int miners, int stations)
+    {
+        std::vector<double> samples;
+        for (int id = 0; id < miners; id++)
+        {
+            for (const auto &[name, values] : metricsHandler.GetMetrics("Miner-" + std::to_string(id + 1)))
+                samples.insert(samples.end(), values.begin(), values.end());
+        }
+        for (int id = 0; id < stations; id++)
+        {
+            for (const auto &[name, values] : metricsHandler.GetMetrics("Station-" + std::to_string(id + 1)))
+                samples.insert(samples.end(), values.begin(), values.end());
+        }
+        return samples;
+    }
+
+    std::vector<double> RunInProcess(int engine, unsigned int workers, int miners, int stations, uint64_t seed, int horizon)
+    {
+        MetricsHandler metricsHandler;
+        MinerManager minerManager(miners, seed);
+        StationManager stationManager(stations, miners);
+        TickHandler tickHandler(minerManager, stationManager, 0, workers, metricsHandler);
+        tickHandler.SetEngine(engine);
+        tickHandler.SetHorizon(horizon);
+        tickHandler.start();
+        tickHandler.wait();
+        return Samples(metricsHandler, miners, stations);
+    }
+}
+
+TEST(DistributedRunnerTest, TestLockstepMatchesSequentialRun)
+{
+    auto sequential = RunInProcess(TickHandler::LOCKSTEP, 1, 300, 4, 11, 300);
+    ASSERT_FALSE(sequential.empty());
+    EXPECT_EQ(RunInProcess(TickHandler::LOCKSTEP, 4, 300, 4, 11, 300), sequential);
+    // The event engine commits in the same order, it only skips the ticks where nothing happens
+    EXPECT_EQ(RunInProcess(TickHandler::EVENT, 1, 300, 4, 11, 300), sequential);
+}
+
+TEST(DistributedRunnerTest, TestWorkerProcessesMatchSingleProcess)
+{
+    auto single = RunInProcess(TickHandler::LOCKSTEP, 1, 250, 3, 7, 250);
+
+    MetricsHandler metricsHandler;
+    DistributedRunner runner(250, 3, 7, 3, metricsHandler);
+    runner.SetHorizon(250);
+    runner.Run();
+    EXPECT_EQ(Samples(metricsHandler, 250, 3), single);
+}
+
+TEST(DistributedRunnerTest, TestRejectsEmptyRun)
+{
+    EXPECT_THROW(DistributedRunner(0, 3, 7, 2), std::invalid_argument);
+    EXPECT_THROW(DistributedRunner(10, 3, 7, 0), std::invalid_argument);
+}
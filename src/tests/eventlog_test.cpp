@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/tickhandler.h"
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    // Collects every series' samples, miners first, then stations
+    std::vector<double> Samples(MetricsHandler &metricsHandler, int miners, int stations)
+    {
+        std::vector<double> samples;
+        for (int id = 0; id < miners; id++)
+        {
+            for (const auto &[name, values] : metricsHandler.GetMetrics("Miner-" + std::to_string(id + 1)))
+                samples.insert(samples.end(), values.begin(), values.end());
+        }
+        for (int id = 0; id < stations; id++)
+        {
+            for (const auto &[name, values] : metricsHandler.GetMetrics("Station-" + std::to_string(id + 1)))
+                samples.insert(samples.end(), values.begin(), values.end());
+        }
+        return samples;
+    }
+
+    std::vector<double> RunWithLog(int engine, unsigned int workers, EventLog *eventLog, MetricsHandler &metricsHandler)
+    {
+        MinerManager minerManager(120, 21);
+        StationManager stationManager(4, 120);
+        TickHandler tickHandler(minerManager, stationManager, 0, workers, metricsHandler);
+        tickHandler.SetEngine(engine);
+        tickHandler.SetHorizon(300);
+        tickHandler.SetEventLog(eventLog);
+        tickHandler.start();
+        tickHandler.wait();
+        return Samples(metricsHandler, 120, 4);
+    }
+}
+
+TEST(EventLogTest, TestReplayMatchesRecordedMetrics)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "mining_sim_eventlog_test.msel").string();
+    for (int engine : {TickHandler::TICK, TickHandler::EVENT, TickHandler::LOCKSTEP})
+    {
+        MetricsHandler recorded;
+        auto expected = RunWithLog(engine, 1, nullptr, recorded);
+        ASSERT_FALSE(expected.empty());
+
+        {
+            MetricsHandler unused;
+            EventLog eventLog(path, 1, 16);
+            // The log takes the place of the samples, and arenas grow past a tiny capacity
+            EXPECT_TRUE(RunWithLog(engine, 1, &eventLog, unused).empty());
+            eventLog.Close();
+        }
+
+        EventLogReader reader(path);
+        EXPECT_EQ(reader.GetMiners(), 120);
+        EXPECT_EQ(reader.GetStations(), 4);
+        EXPECT_EQ(reader.GetSeed(), 21u);
+        size_t types[EventLog::EVENT_TYPE_COUNT] = {};
+        int previous = 0;
+        for (const auto &event : reader)
+        {
+            ASSERT_GE(event.type, 0);
+            ASSERT_LT(event.type, EventLog::EVENT_TYPE_COUNT);
+            types[event.type]++;
+            EXPECT_GE(event.tick, previous);
+            previous = event.tick;
+        }
+        // Every miner starts mining at tick 0, then every unload starts a new cycle
+        EXPECT_EQ(types[EventLog::START_MINING], 120 + types[EventLog::UNLOAD]);
+        EXPECT_GT(types[EventLog::ENQUEUE], 0u);
+
+        MetricsHandler replayed;
+        reader.Replay(replayed);
+        EXPECT_EQ(Samples(replayed, 120, 4), expected);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(EventLogTest, TestArenasPerWorkerAreRequired)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "mining_sim_eventlog_arenas.msel").string();
+    {
+        MinerManager minerManager(10, 1);
+        StationManager stationManager(2, 10);
+        TickHandler tickHandler(minerManager, stationManager, 0, 2);
+        EventLog eventLog(path, 1);
+        EXPECT_THROW(tickHandler.SetEventLog(&eventLog), std::invalid_argument);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(EventLogTest, TestRejectsOtherFiles)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "mining_sim_eventlog_other.msel").string();
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "not an event log, just some text that is long enough";
+    }
+    EXPECT_THROW(EventLogReader reader(path), std::runtime_error);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/lockfreequeue.h"
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+class LockFreeQueueTest : public ::testing::Test
+{
+    public:
+        std::shared_ptr<QueueNodePool> pool = std::make_shared<QueueNodePool>(4096);
+};
+
+TEST_F(LockFreeQueueTest, TestFifoOrderAndPeek)
+{
+    LockFreeQueue queue(pool);
+    int value = -1;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.peek(value));
+
+    for (int i = 0; i < 10; i++)
+        queue.push(i);
+    EXPECT_EQ(queue.size(), 10u);
+    EXPECT_TRUE(queue.peek(value));
+    EXPECT_EQ(value, 0);
+
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(LockFreeQueueTest, TestQueuesShareAndRecycleNodes)
+{
+    auto shared = std::make_shared<QueueNodePool>(3);
+    LockFreeQueue first(shared);
+    LockFreeQueue second(shared);
+    int value;
+
+    // Two dummies plus one element use the whole pool, recycling must keep it usable
+    for (int i = 0; i < 100; i++)
+    {
+        first.push(i);
+        EXPECT_THROW(second.push(i), std::length_error);
+        EXPECT_TRUE(first.pop(value));
+        second.push(i);
+        EXPECT_TRUE(second.pop(value));
+        EXPECT_EQ(value, i);
+    }
+}
+
+TEST_F(LockFreeQueueTest, TestConcurrentProducersAndConsumers)
+{
+    LockFreeQueue queue(pool);
+    const int threads = 4;
+    const int perThread = 20000;
+    std::vector<std::vector<int>> popped(threads);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]()
+                             {
+                                 int value;
+                                 for (int i = 0; i < perThread; i++)
+                                 {
+                                     queue.push(t * perThread + i);
+                                     while (!queue.pop(value))
+                                     {
+                                     }
+                                     popped[t].push_back(value);
+                                 }
+                             });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    std::vector<int> all;
+    for (auto &values : popped)
+        all.insert(all.end(), values.begin(), values.end());
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), static_cast<size_t>(threads * perThread));
+    for (int i = 0; i < threads * perThread; i++)
+        EXPECT_EQ(all[i], i);
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/tickhandler.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+    const int MINERS = 120;
+    const int STATIONS = 3;
+    const int HORIZON = 200;
+
+    void RunSimulation(MetricsHandler &metricsHandler, MetricsFlusher *flusher)
+    {
+        MinerManager minerManager(MINERS, 5);
+        StationManager stationManager(STATIONS, MINERS);
+        TickHandler tickHandler(minerManager, stationManager, 0, 2, metricsHandler);
+        // Lockstep runs do not depend on how the workers interleave
+        tickHandler.SetEngine(TickHandler::LOCKSTEP);
+        tickHandler.SetHorizon(HORIZON);
+        tickHandler.SetMetricsFlusher(flusher);
+        tickHandler.start();
+        tickHandler.wait();
+    }
+}
+
+TEST(MetricsFlusherTest, TestFlushedSamplesMatchKeptSamples)
+{
+    MetricsHandler kept;
+    RunSimulation(kept, nullptr);
+
+    const std::string path = "metricsflusher_test.ndjson";
+    MetricsHandler flushed;
+    {
+        MetricsFlusher flusher(path, MetricsFlusher::NDJSON, 7, flushed);
+        RunSimulation(flushed, &flusher);
+        flusher.Close();
+        EXPECT_GT(flusher.GetWritten(), 0u);
+    }
+
+    // Lines of a series come in tick order, flush after flush
+    std::map<std::pair<std::string, std::string>, std::vector<double>> series;
+    std::ifstream file(path);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(file, line))
+    {
+        nlohmann::json sample = nlohmann::json::parse(line);
+        series[{sample["asset"], sample["metric"]}].push_back(sample["value"]);
+        EXPECT_LT(sample["tick"].get<int>(), HORIZON);
+        lines++;
+    }
+    file.close();
+    std::filesystem::remove(path);
+    ASSERT_FALSE(series.empty());
+
+    size_t samples = 0;
+    for (const auto &[key, values] : series)
+    {
+        auto view = kept.GetSeries(key.first, key.second);
+        EXPECT_EQ(values, std::vector<double>(view.begin(), view.end())) << key.first << " " << key.second;
+        samples += values.size();
+        // The summary aggregates still cover every sample
+        EXPECT_EQ(flushed.GetAggregates(key.first)[key.second].GetCount(), values.size());
+    }
+    EXPECT_EQ(samples, lines);
+    // Nothing was kept in memory
+    EXPECT_TRUE(flushed.GetSeries("Station-1", "QueueTimes").empty());
+}
+
+TEST(MetricsFlusherTest, TestFlushFilesAroundCheckpointCoverTheRun)
+{
+    MetricsHandler kept;
+    RunSimulation(kept, nullptr);
+
+    const int checkpointTick = 100;
+    const std::string checkpointPath = (std::filesystem::temp_directory_path() / "metricsflusher_test.msck").string();
+    const std::string paths[] = {"metricsflusher_test_first.ndjson", "metricsflusher_test_resumed.ndjson"};
+    std::map<std::pair<std::string, std::string>, std::vector<double>> series;
+    auto readFile = [&series](const std::string &path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            nlohmann::json sample = nlohmann::json::parse(line);
+            series[{sample["asset"], sample["metric"]}].push_back(sample["value"]);
+        }
+    };
+
+    {
+        MetricsHandler metricsHandler;
+        // The interval does not divide the checkpoint tick, so a partial interval is pending when it is taken
+        MetricsFlusher flusher(paths[0], MetricsFlusher::NDJSON, 7, metricsHandler);
+        MinerManager minerManager(MINERS, 5);
+        StationManager stationManager(STATIONS, MINERS);
+        TickHandler tickHandler(minerManager, stationManager, 0, 2, metricsHandler);
+        tickHandler.SetEngine(TickHandler::LOCKSTEP);
+        tickHandler.SetHorizon(checkpointTick);
+        tickHandler.SetMetricsFlusher(&flusher);
+        tickHandler.SetCheckpoint(checkpointTick, checkpointPath);
+        tickHandler.start();
+        tickHandler.wait();
+        // Read before closing, as if the run had been killed right after the checkpoint
+        readFile(paths[0]);
+    }
+    {
+        MetricsHandler metricsHandler;
+        MinerManager minerManager(MINERS, 99);
+        StationManager stationManager(STATIONS, MINERS);
+        TickHandler tickHandler(minerManager, stationManager, 0, 2, metricsHandler);
+        tickHandler.SetEngine(TickHandler::LOCKSTEP);
+        tickHandler.SetHorizon(HORIZON);
+        tickHandler.RestoreCheckpoint(checkpointPath);
+        EXPECT_TRUE(metricsHandler.IsStreaming());
+        MetricsFlusher flusher(paths[1], MetricsFlusher::NDJSON, 7, metricsHandler);
+        tickHandler.SetMetricsFlusher(&flusher);
+        tickHandler.start();
+        tickHandler.wait();
+        flusher.Close();
+        readFile(paths[1]);
+    }
+    for (const auto &path : paths)
+        std::filesystem::remove(path);
+    std::filesystem::remove(checkpointPath);
+
+    ASSERT_FALSE(series.empty());
+    for (const auto &[key, values] : series)
+    {
+        auto view = kept.GetSeries(key.first, key.second);
+        EXPECT_EQ(values, std::vector<double>(view.begin(), view.end())) << key.first << " " << key.second;
+    }
+}
+
+TEST(MetricsFlusherTest, TestCsvRowsAndManualFlushes)
+{
+    const std::string path = "metricsflusher_test.csv";
+    MetricsHandler metricsHandler;
+    MetricsFlusher flusher(path, MetricsFlusher::CSV, 1, metricsHandler);
+    for (int tick = 0; tick < 50; tick++)
+    {
+        metricsHandler.RecordMetric("Miner-1", "Load", tick * 0.25, tick);
+        if (tick % 10 == 9)
+            flusher.Flush();
+    }
+    flusher.Close();
+    EXPECT_EQ(flusher.GetWritten(), 50u);
+
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    EXPECT_EQ(line, "Asset,Metric,Tick,Value");
+    std::getline(file, line);
+    EXPECT_EQ(line, "Miner-1,Load,0,0.0");
+    size_t rows = 1;
+    while (std::getline(file, line))
+        rows++;
+    EXPECT_EQ(rows, 50u);
+    file.close();
+    std::filesystem::remove(path);
+
+    EXPECT_THROW(MetricsFlusher("missing_directory/metrics.csv", MetricsFlusher::CSV, 1, metricsHandler), std::runtime_error);
+}
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/metricshandler.h"
+#include <thread>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <set>
+
+TEST(MetricsHandlerTest, TestConcurrentRecordingIsMergedByTick)
+{
+    MetricsHandler &metricsHandler = MetricsHandler::GetInstance();
+    const int threads = 8;
+    const int ticks = 2000;
+    std::vector<std::thread> workers;
+
+    // Every thread records the same series, interleaved by tick
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&metricsHandler, t]()
+                             {
+                                 for (int tick = t; tick < ticks; tick += threads)
+                                     metricsHandler.RecordMetric("Concurrent-1", "Value", tick, tick);
+                             });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    auto values = metricsHandler.GetMetrics("Concurrent-1")["Value"];
+    ASSERT_EQ(values.size(), static_cast<size_t>(ticks));
+    for (int tick = 0; tick < ticks; tick++)
+        EXPECT_EQ(values[tick], tick);
+}
+
+TEST(MetricsHandlerTest, TestStreamedJsonMatchesDocumentDump)
+{
+    MetricsHandler &metricsHandler = MetricsHandler::GetInstance();
+    // Tiny, huge and integral values cross nlohmann's switches between fixed and exponent notation
+    std::vector<double> values = {1.0, 0.1, 2.5e-7, 123456789.125, -3.0, 0.0001, 0.00001, 1e-300, 5e-324, 42.0, 0.0, -0.0,
+                                  1e14, 1e15, 123456789012345.0, 1234567890123456789.0, 1.7976931348623157e308, -2.5e20};
+    for (size_t i = 0; i < values.size(); i++)
+        metricsHandler.RecordMetric("Export \"1\"", "Value", values[i], static_cast<int>(i));
+    metricsHandler.SaveMetricsToJson("jsonexport_test.json");
+
+    std::string path;
+    for (const auto &entry : std::filesystem::directory_iterator("."))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("jsonexport_test_", 0) == 0)
+            path = entry.path().string();
+    }
+    ASSERT_FALSE(path.empty());
+    std::ifstream file(path);
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove(path);
+
+    nlohmann::json json = nlohmann::json::parse(text);
+    EXPECT_EQ(json["Export \"1\""]["Value"].get<std::vector<double>>(), values);
+    // Same text the document-based export produced
+    EXPECT_EQ(text, json.dump(4));
+}
+
+TEST(MetricsHandlerTest, TestSeriesViewsReadStoredSamplesInPlace)
+{
+    MetricsHandler metricsHandler;
+    for (int tick = 0; tick < 10; tick++)
+        metricsHandler.RecordMetric("Miner-1", "Mining Time", tick * 0.5, tick * 2);
+
+    auto series = metricsHandler.GetSeries("Miner-1", "Mining Time");
+    ASSERT_EQ(series.size(), 10u);
+    EXPECT_EQ(std::vector<double>(series.begin(), series.end()), metricsHandler.GetMetrics("Miner-1")["Mining Time"]);
+    EXPECT_EQ(series.GetTick(3), 6);
+    // Views of the same series share its storage
+    EXPECT_EQ(metricsHandler.GetSeries("Miner-1", "Mining Time").begin(), series.begin());
+
+    auto window = metricsHandler.GetSeries("Miner-1", "Mining Time", 5, 11);
+    ASSERT_EQ(window.size(), 3u);
+    EXPECT_EQ(window.GetTick(0), 6);
+    EXPECT_EQ(window[2], 2.5);
+    EXPECT_TRUE(series.Between(19, 100).empty());
+    EXPECT_TRUE(series.Between(7, 7).empty());
+    EXPECT_TRUE(metricsHandler.GetSeries("Miner-2", "Mining Time").empty());
+    EXPECT_TRUE(metricsHandler.GetSeries("Miner-1", "Unknown").empty());
+}
+
+TEST(MetricsHandlerTest, TestLateSamplesAreMergedInTickOrder)
+{
+    MetricsHandler metricsHandler;
+    metricsHandler.RecordMetric("Station-1", "Queue Times", 1.0, 1);
+    metricsHandler.RecordMetric("Station-1", "Queue Times", 5.0, 5);
+    metricsHandler.GetSeries("Station-1", "Queue Times");
+    metricsHandler.RecordMetric("Station-1", "Queue Times", 3.0, 3);
+    metricsHandler.RecordMetric("Station-1", "Queue Times", 5.5, 5);
+
+    auto series = metricsHandler.GetSeries("Station-1", "Queue Times");
+    EXPECT_EQ(std::vector<double>(series.begin(), series.end()), (std::vector<double>{1.0, 3.0, 5.0, 5.5}));
+    EXPECT_EQ(std::vector<int>(series.GetTicks(), series.GetTicks() + series.size()), (std::vector<int>{1, 3, 5, 5}));
+}
+
+TEST(MetricsHandlerTest, TestShardedExportSkipsAssetsWithoutSeries)
+{
+    MetricsHandler metricsHandler;
+    metricsHandler.RegisterAsset("Shard-Empty");
+    metricsHandler.RecordMetric("Shard-Full", "Value", 0.0001, 0);
+    metricsHandler.SaveMetricsToJsonShards("shardexport_test.json", 2);
+
+    std::string directory;
+    for (const auto &entry : std::filesystem::directory_iterator("."))
+    {
+        if (entry.path().filename().string().rfind("shardexport_test_", 0) == 0)
+            directory = entry.path().string();
+    }
+    ASSERT_FALSE(directory.empty());
+    EXPECT_TRUE(std::filesystem::exists(directory + "/Shard-Full.json"));
+    EXPECT_FALSE(std::filesystem::exists(directory + "/Shard-Empty.json"));
+    std::ifstream file(directory + "/Shard-Full.json");
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove_all(directory);
+    EXPECT_EQ(text, nlohmann::json::parse(text).dump(4));
+}
+
+TEST(MetricsHandlerTest, TestStreamedMetricsAreNotSavedAsEmptyColumnarFile)
+{
+    MetricsHandler metricsHandler;
+    metricsHandler.SetStreaming(true);
+    metricsHandler.RecordMetric("Miner-1", "Load", 0.5, 0);
+    metricsHandler.SaveMetricsToColumnar("columnarstream_test.msc");
+
+    bool written = false;
+    for (const auto &entry : std::filesystem::directory_iterator("."))
+        written = written || entry.path().filename().string().rfind("columnarstream_test_", 0) == 0;
+    EXPECT_FALSE(written);
+}
+
+TEST(MetricsHandlerTest, TestSummaryFiguresAreNotRecordedAsSeries)
+{
+    for (bool streaming : {false, true})
+    {
+        MetricsHandler metricsHandler;
+        metricsHandler.SetStreaming(streaming);
+        for (int tick = 0; tick < 4; tick++)
+            metricsHandler.RecordMetric("Miner-1", "DistanceTraveled", tick + 1.0, tick);
+
+        // ListAllMetrics saves its own export, only the files it adds are removed
+        std::set<std::filesystem::path> before;
+        for (const auto &entry : std::filesystem::directory_iterator("."))
+            before.insert(entry.path());
+        metricsHandler.ListAllMetrics();
+        for (const auto &entry : std::filesystem::directory_iterator("."))
+        {
+            if (!before.count(entry.path()))
+                std::filesystem::remove_all(entry.path());
+        }
+
+        EXPECT_EQ(metricsHandler.GetAggregates("Miner-1").count("DistanceTraveled-Total"), 0u);
+        EXPECT_TRUE(metricsHandler.GetSeries("Miner-1", "DistanceTraveled-Total").empty());
+
+        metricsHandler.SaveMetricsToJson("summaryexport_test.json");
+        std::string path;
+        for (const auto &entry : std::filesystem::directory_iterator("."))
+        {
+            if (entry.path().filename().string().rfind("summaryexport_test_", 0) == 0)
+                path = entry.path().string();
+        }
+        ASSERT_FALSE(path.empty());
+        std::ifstream file(path);
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+        std::filesystem::remove(path);
+
+        nlohmann::json json = nlohmann::json::parse(text);
+        EXPECT_EQ(json["Miner-1"]["DistanceTraveled-Total"], nlohmann::json::array({10.0}));
+        EXPECT_EQ(json["Miner-1"]["DistanceTraveled-Max"], nlohmann::json::array({4.0}));
+        if (streaming)
+            EXPECT_EQ(json["Miner-1"]["DistanceTraveled"]["Count"], 4);
+        else
+            EXPECT_EQ(json["Miner-1"]["DistanceTraveled"].size(), 4u);
+        EXPECT_EQ(text, json.dump(4));
+    }
+}
+
+TEST(MetricsHandlerTest, TestThreadsSwitchingHandlersKeepTheirSamples)
+{
+    // Every switch misses the thread's one-entry cache and finds the thread's shard again
+    MetricsHandler first;
+    MetricsHandler second;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; t++)
+    {
+        workers.emplace_back([&first, &second, t]()
+                             {
+                                 for (int tick = 0; tick < 500; tick++)
+                                 {
+                                     first.RecordMetric("Switch-" + std::to_string(t), "Value", tick, tick);
+                                     second.RecordMetric("Switch-" + std::to_string(t), "Value", -tick, tick);
+                                 } });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    for (int t = 0; t < 4; t++)
+    {
+        auto values = first.GetMetrics("Switch-" + std::to_string(t))["Value"];
+        auto negated = second.GetMetrics("Switch-" + std::to_string(t))["Value"];
+        ASSERT_EQ(values.size(), 500u);
+        ASSERT_EQ(negated.size(), 500u);
+        for (int tick = 0; tick < 500; tick++)
+        {
+            EXPECT_EQ(values[tick], tick);
+            EXPECT_EQ(negated[tick], -tick);
+        }
+    }
+}
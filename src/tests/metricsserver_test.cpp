@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/metricsserver.h"
+#include "../inlcude/utils/tickhandler.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+TEST(MetricsServerTest, TestLiveCountersFollowTheRun)
+{
+    MetricsHandler metricsHandler;
+    MinerManager minerManager(30, 4);
+    StationManager stationManager(3, 30);
+    TickHandler tickHandler(minerManager, stationManager, 0, 2, metricsHandler);
+    LiveMetrics liveMetrics(3);
+    tickHandler.SetLiveMetrics(&liveMetrics);
+    tickHandler.SetHorizon(120);
+    tickHandler.start();
+    tickHandler.wait();
+
+    std::string exposition = liveMetrics.Render();
+    EXPECT_NE(exposition.find("mining_sim_tick 120\n"), std::string::npos);
+    EXPECT_NE(exposition.find("mining_sim_snapshot_tick 120\n"), std::string::npos);
+    size_t unloads = 0;
+    for (int station = 1; station <= 3; station++)
+        unloads += metricsHandler.GetMetrics("Station-" + std::to_string(station))["UtilizationRate"].size();
+    EXPECT_NE(exposition.find("mining_sim_unloads_total " + std::to_string(unloads) + "\n"), std::string::npos);
+    EXPECT_NE(exposition.find("mining_sim_miners{state=\"mining\"}"), std::string::npos);
+    EXPECT_NE(exposition.find("mining_sim_station_queue_depth{station=\"3\"}"), std::string::npos);
+}
+
+#ifndef _WIN32
+TEST(MetricsServerTest, TestServesMetricsOverHttp)
+{
+    LiveMetrics liveMetrics(2);
+    liveMetrics.SetTick(7);
+    MetricsServer server(liveMetrics, 0);
+    server.Start();
+
+    auto fetch = [&server](const std::string &path)
+    {
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(server.GetPort());
+        std::string response;
+        if (connect(client, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0)
+        {
+            std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+            send(client, request.data(), request.size(), 0);
+            char buffer[4096];
+            ssize_t received;
+            while ((received = recv(client, buffer, sizeof(buffer), 0)) > 0)
+                response.append(buffer, static_cast<size_t>(received));
+        }
+        close(client);
+        return response;
+    };
+
+    std::string metrics = fetch("/metrics");
+    EXPECT_EQ(metrics.rfind("HTTP/1.1 200 OK", 0), 0u);
+    EXPECT_NE(metrics.find("mining_sim_tick 7\n"), std::string::npos);
+    EXPECT_EQ(fetch("/other").rfind("HTTP/1.1 404", 0), 0u);
+    server.Stop();
+}
+
+TEST(MetricsServerTest, TestIdleClientDoesNotBlockServer)
+{
+    LiveMetrics liveMetrics(1);
+    MetricsServer server(liveMetrics, 0);
+    server.Start();
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(server.GetPort());
+    auto open = [&address]()
+    {
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        EXPECT_EQ(connect(client, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+        return client;
+    };
+
+    // An idle client is dropped after SERVER_READ_MS and the next scrape is answered
+    int idle = open();
+    int scrape = open();
+    std::string request = "GET /metrics HTTP/1.1\r\n\r\n";
+    send(scrape, request.data(), request.size(), 0);
+    char buffer[4096];
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_GT(recv(scrape, buffer, sizeof(buffer), 0), 0);
+    EXPECT_EQ(std::string(buffer, 15), "HTTP/1.1 200 OK");
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(SERVER_READ_MS + 1000));
+    close(idle);
+    close(scrape);
+
+    // Stopping does not wait for a connection that never sends anything
+    idle = open();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    start = std::chrono::steady_clock::now();
+    server.Stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(SERVER_READ_MS));
+    close(idle);
+}
+#endif
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/minermanager.h"
+
+class MinerManagerTest : public ::testing::Test
+{
+    public:
+        MinerManager manager{1000};
+};
+
+TEST_F(MinerManagerTest, TestGetSetRoundTrip)
+{
+    Miner miner(5, 30, Miner::STATES::WAITING, Miner::STATUS::QUEUED, 2, 0.8);
+    manager.SetMiner(7, miner);
+    Miner stored = manager.GetMiner(7);
+    EXPECT_EQ(stored.GetTime(), 5);
+    EXPECT_EQ(stored.GetMiningTime(), 30);
+    EXPECT_EQ(stored.GetState(), Miner::STATES::WAITING);
+    EXPECT_EQ(stored.GetQueueStatus(), Miner::STATUS::QUEUED);
+    EXPECT_EQ(stored.GetStationID(), 2);
+    EXPECT_EQ(stored.GetLoad(), 0.8);
+    EXPECT_THROW(manager.GetMiner(1000), std::out_of_range);
+}
+
+TEST_F(MinerManagerTest, TestBatchKernelMatchesMinerTick)
+{
+    // Cover every state, status and countdown edge except entering MINING, which draws random values
+    std::vector<Miner> expected;
+    for (int id = 0; id < manager.GetAssets(); id++)
+    {
+        int state = id % 5;
+        int time = (id / 5) % 4;
+        if (state == Miner::STATES::UNLOADING && time == 0)
+            time = 1;
+        Miner miner(time, 20, state, (id / 20) % 5, id % 3, 0.9);
+        manager.SetMiner(id, miner);
+        miner.tick();
+        expected.push_back(miner);
+    }
+
+    manager.TickBlock(0, manager.GetAssets());
+
+    for (int id = 0; id < manager.GetAssets(); id++)
+    {
+        Miner actual = manager.GetMiner(id);
+        EXPECT_EQ(actual.GetState(), expected[id].GetState()) << "miner " << id;
+        EXPECT_EQ(actual.GetTime(), expected[id].GetTime()) << "miner " << id;
+        EXPECT_EQ(actual.GetQueueStatus(), expected[id].GetQueueStatus()) << "miner " << id;
+        EXPECT_EQ(actual.GetStationID(), expected[id].GetStationID()) << "miner " << id;
+    }
+}
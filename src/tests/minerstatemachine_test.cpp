@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "../inlcude/assets/minerstatemachine.h"
+
+// The tables are folded at compile time
+static_assert(MinerMachine::TIMED == ((1u << Miner::MINING) | (1u << Miner::RETURN) | (1u << Miner::UNLOADING)), "Timed states");
+static_assert(MinerMachine::TABLE[Miner::SEARCHING].onStatus[Miner::QUEUED] == Miner::WAITING, "Searching miners queue up");
+
+TEST(MinerStateMachineTest, TestConfiguredScenarioDrivesDurations)
+{
+    Scenario scenario;
+    scenario.miningMin = 3;
+    scenario.miningMax = 3;
+    scenario.returnTicks = 2;
+    scenario.unloadTicks = 3;
+    ConfiguredScenario::Set(scenario);
+
+    Miner miner;
+    EXPECT_EQ(miner.GetTime(), 3);
+    for (int i = 0; i < 4; i++)
+        miner.tick();
+    EXPECT_EQ(miner.GetState(), Miner::SEARCHING);
+    miner.SetQueueStatus(Miner::FRONT);
+    miner.tick();
+    EXPECT_EQ(miner.GetState(), Miner::RETURN);
+    EXPECT_EQ(miner.GetTime(), 2);
+    for (int i = 0; i < 3; i++)
+        miner.tick();
+    EXPECT_EQ(miner.GetState(), Miner::UNLOADING);
+
+    // A longer unload is flagged complete once, on its last countdown tick
+    int completions = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        miner.tick();
+        completions += miner.GetQueueStatus() == Miner::COMPLETE;
+    }
+    EXPECT_EQ(completions, 1);
+    EXPECT_EQ(miner.GetQueueStatus(), Miner::COMPLETE);
+    miner.tick();
+    EXPECT_EQ(miner.GetState(), Miner::MINING);
+
+    ConfiguredScenario::Set(Scenario());
+}
+
+TEST(MinerStateMachineTest, TestInvalidScenariosAreRejected)
+{
+    Scenario noUnload;
+    noUnload.unloadTicks = 0;
+    EXPECT_THROW(ConfiguredScenario::Set(noUnload), std::invalid_argument);
+    Scenario inverted;
+    inverted.miningMin = 30;
+    inverted.miningMax = 20;
+    EXPECT_THROW(ConfiguredScenario::Set(inverted), std::invalid_argument);
+    EXPECT_EQ(ConfiguredScenario::Get().returnTicks, RETURN_TICKS);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/randomstream.h"
+#include "../inlcude/utils/minermanager.h"
+
+TEST(RandomStreamTest, TestMatchesPhiloxKnownAnswer)
+{
+    // Philox4x32-10 of a zero key and counter is 6627e8d5 e169c58d ..., the top 53 bits of the first two words make the draw
+    RandomStream stream(0, 0);
+    EXPECT_EQ(stream.Uniform(0.0, 1.0), static_cast<double>(0x6627e8d5e169c58dull >> 11) / 9007199254740992.0);
+    EXPECT_EQ(stream.GetCounter(), 1u);
+}
+
+TEST(RandomStreamTest, TestDrawsAreReproducibleAndIndependent)
+{
+    RandomStream first(42, RandomStream::Entity(RandomStream::MINER, 7));
+    RandomStream again(42, RandomStream::Entity(RandomStream::MINER, 7));
+    RandomStream other(42, RandomStream::Entity(RandomStream::MINER, 8));
+    RandomStream reseeded(43, RandomStream::Entity(RandomStream::MINER, 7));
+
+    int differentEntity = 0, differentSeed = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        double value = first.Uniform(0.75, 1.0);
+        EXPECT_EQ(value, again.Uniform(0.75, 1.0));
+        EXPECT_GE(value, 0.75);
+        EXPECT_LT(value, 1.0);
+        differentEntity += value != other.Uniform(0.75, 1.0);
+        differentSeed += value != reseeded.Uniform(0.75, 1.0);
+
+        int draw = first.UniformInt(12, 60);
+        again.UniformInt(12, 60);
+        EXPECT_GE(draw, 12);
+        EXPECT_LE(draw, 60);
+    }
+    EXPECT_EQ(differentEntity, 1000);
+    EXPECT_EQ(differentSeed, 1000);
+    EXPECT_EQ(first.GetCounter(), 2000u);
+
+    // A restored counter continues the stream exactly
+    RandomStream restored(42, RandomStream::Entity(RandomStream::MINER, 7), first.GetCounter());
+    EXPECT_EQ(restored.Uniform(0.0, 1.0), first.Uniform(0.0, 1.0));
+}
+
+TEST(RandomStreamTest, TestBatchFillUsesTwoDrawsPerCounter)
+{
+    RandomStream batch(1, 2);
+    double values[5];
+    batch.Fill(values, 5, 0.0, 0.02);
+    EXPECT_EQ(batch.GetCounter(), 3u);
+
+    // The first half of each block is what a single draw returns
+    RandomStream single(1, 2);
+    EXPECT_EQ(values[0], single.Uniform(0.0, 0.02));
+    EXPECT_EQ(values[2], single.Uniform(0.0, 0.02));
+    for (double value : values)
+    {
+        EXPECT_GE(value, 0.0);
+        EXPECT_LT(value, 0.02);
+    }
+}
+
+TEST(RandomStreamTest, TestSeedReproducesTheFleet)
+{
+    MinerManager first(500, 2024);
+    MinerManager again(500, 2024);
+    MinerManager other(500, 2025);
+    int differences = 0;
+    for (int id = 0; id < 500; id++)
+    {
+        EXPECT_EQ(first.GetMiner(id).GetTime(), again.GetMiner(id).GetTime());
+        EXPECT_EQ(first.GetMiner(id).GetLoad(), again.GetMiner(id).GetLoad());
+        EXPECT_EQ(first.GetMiner(id).GetRandom().GetCounter(), 1u);
+        differences += first.GetMiner(id).GetLoad() != other.GetMiner(id).GetLoad();
+    }
+    EXPECT_GT(differences, 490);
+}
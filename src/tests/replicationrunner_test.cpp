@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/replicationrunner.h"
+
+TEST(ReplicationRunnerTest, TestReplicationsAreReproducibleAndSummarized)
+{
+    ReplicationRunner first(30, 5, 4, 11, 4);
+    ReplicationRunner again(30, 5, 4, 11, 2);
+    first.SetEngine(TickHandler::EVENT);
+    again.SetEngine(TickHandler::EVENT);
+    first.Run();
+    again.Run();
+
+    const auto &summaries = first.GetSummaries();
+    ASSERT_EQ(summaries.size(), again.GetSummaries().size());
+    ASSERT_FALSE(summaries.empty());
+    for (size_t i = 0; i < summaries.size(); i++)
+    {
+        // Results do not depend on how replications were spread over workers
+        EXPECT_EQ(summaries[i].name, again.GetSummaries()[i].name);
+        EXPECT_EQ(summaries[i].mean, again.GetSummaries()[i].mean);
+        EXPECT_EQ(summaries[i].replications, 4u);
+        EXPECT_LE(summaries[i].low, summaries[i].mean);
+        EXPECT_GE(summaries[i].high, summaries[i].mean);
+    }
+}
+
+TEST(ReplicationRunnerTest, TestStudentCriticalValues)
+{
+    EXPECT_DOUBLE_EQ(ReplicationRunner::StudentT(1), 12.706);
+    EXPECT_DOUBLE_EQ(ReplicationRunner::StudentT(30), 2.042);
+    EXPECT_NEAR(ReplicationRunner::StudentT(60), 2.000, 0.001);
+    EXPECT_NEAR(ReplicationRunner::StudentT(1000), 1.962, 0.001);
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/metricshandler.h"
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <string>
+#include <filesystem>
+
+namespace
+{
+    // Records a run's worth of miner and station samples, compacting hourly as TickHandler does
+    void RecordRun(MetricsHandler &metricsHandler, int ticks)
+    {
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            metricsHandler.RecordMetric("Miner-1", "DistanceTraveled", tick % 9, tick);
+            if (tick % 3 == 0)
+            {
+                metricsHandler.RecordMetric("Station-1", "MaterialVolume", 0.5 * (tick % 4), tick);
+                metricsHandler.RecordMetric("Station-1", "UtilizationRate", 1.0, tick);
+                metricsHandler.RecordMetric("Station-1", "MaterialQuality", 1.0 + tick % 5, tick);
+            }
+            if ((tick + 1) % ROLLUP_HOUR_TICKS == 0)
+                metricsHandler.Compact();
+        }
+    }
+
+    // The summary ListAllMetrics prints, without percentiles, which are sketched from aggregates and exact from samples
+    std::vector<std::string> Summary(MetricsHandler &metricsHandler)
+    {
+        std::set<std::filesystem::path> before;
+        for (const auto &entry : std::filesystem::directory_iterator("."))
+            before.insert(entry.path());
+        testing::internal::CaptureStdout();
+        metricsHandler.ListAllMetrics();
+        std::istringstream output(testing::internal::GetCapturedStdout());
+        // Only the exports ListAllMetrics adds are removed
+        for (const auto &entry : std::filesystem::directory_iterator("."))
+        {
+            if (!before.count(entry.path()))
+                std::filesystem::remove_all(entry.path());
+        }
+
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(output, line))
+        {
+            if (line.rfind("Category", 0) == 0 || line.rfind("  ", 0) == 0)
+                lines.push_back(line.substr(0, line.find(", P50")));
+        }
+        return lines;
+    }
+}
+
+TEST(RollupStoreTest, TestBucketsMatchRawSamples)
+{
+    MetricsHandler metricsHandler;
+    metricsHandler.SetRollups({ROLLUP_HOUR_TICKS, ROLLUP_DAY_TICKS});
+    const int ticks = 2 * ROLLUP_DAY_TICKS + 5;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        // Two samples on even ticks, none on odd ones
+        if (tick % 2 == 0)
+        {
+            metricsHandler.RecordMetric("Station-1", "Queue Times", tick % 7, tick);
+            metricsHandler.RecordMetric("Station-1", "Queue Times", -(tick % 5), tick);
+        }
+    }
+
+    auto series = metricsHandler.GetSeries("Station-1", "Queue Times");
+    for (int width : {ROLLUP_HOUR_TICKS, ROLLUP_DAY_TICKS})
+    {
+        auto buckets = metricsHandler.GetRollup("Station-1", "Queue Times", width);
+        ASSERT_EQ(buckets.size(), static_cast<size_t>((ticks + width - 1) / width));
+        for (const auto &bucket : buckets)
+        {
+            auto window = series.Between(bucket.start, bucket.start + width);
+            EXPECT_EQ(bucket.count, window.size());
+            EXPECT_DOUBLE_EQ(bucket.sum, std::accumulate(window.begin(), window.end(), 0.0));
+            EXPECT_EQ(bucket.min, *std::min_element(window.begin(), window.end()));
+            EXPECT_EQ(bucket.max, *std::max_element(window.begin(), window.end()));
+        }
+    }
+    EXPECT_TRUE(metricsHandler.GetRollup("Station-1", "Queue Times", 5).empty());
+    EXPECT_TRUE(metricsHandler.GetRollup("Station-2", "Queue Times", ROLLUP_HOUR_TICKS).empty());
+}
+
+TEST(RollupStoreTest, TestRawWindowKeepsLatestTicks)
+{
+    MetricsHandler metricsHandler;
+    metricsHandler.SetRollups({ROLLUP_HOUR_TICKS}, 24);
+    for (int tick = 0; tick < 100; tick++)
+    {
+        metricsHandler.RecordMetric("Miner-1", "Mining Time", tick, tick);
+        // Compacting as TickHandler does keeps the raw samples bounded during the run
+        if ((tick + 1) % ROLLUP_HOUR_TICKS == 0)
+            metricsHandler.Compact();
+    }
+    metricsHandler.RecordMetric("Miner-1", "Mining Time", -1.0);
+
+    auto series = metricsHandler.GetSeries("Miner-1", "Mining Time");
+    ASSERT_EQ(series.size(), 25u);
+    EXPECT_EQ(series.GetTick(0), -1);
+    EXPECT_EQ(series.GetTick(1), 76);
+    // The rollups still cover the whole run
+    auto buckets = metricsHandler.GetRollup("Miner-1", "Mining Time", ROLLUP_HOUR_TICKS);
+    ASSERT_EQ(buckets.size(), 9u);
+    EXPECT_EQ(buckets.front().count, static_cast<uint64_t>(ROLLUP_HOUR_TICKS));
+    EXPECT_EQ(buckets.back().start, 96);
+    EXPECT_EQ(buckets.back().max, 99.0);
+}
+
+TEST(RollupStoreTest, TestLateSamplesAndStreaming)
+{
+    MetricsHandler metricsHandler;
+    metricsHandler.SetStreaming(true);
+    metricsHandler.SetRollups({10});
+    metricsHandler.RecordMetric("Miner-1", "Load", 4.0, 25);
+    metricsHandler.GetRollup("Miner-1", "Load", 10);
+    metricsHandler.RecordMetric("Miner-1", "Load", 2.0, 3);
+    metricsHandler.RecordMetric("Miner-1", "Load", 6.0, 27);
+
+    auto buckets = metricsHandler.GetRollup("Miner-1", "Load", 10);
+    ASSERT_EQ(buckets.size(), 2u);
+    EXPECT_EQ(buckets[0].start, 0);
+    EXPECT_EQ(buckets[1].start, 20);
+    EXPECT_EQ(buckets[1].count, 2u);
+    EXPECT_EQ(buckets[1].Mean(), 5.0);
+    // Streaming keeps aggregates and rollups, never the raw samples
+    EXPECT_TRUE(metricsHandler.GetSeries("Miner-1", "Load").empty());
+    EXPECT_EQ(metricsHandler.GetAggregates("Miner-1")["Load"].GetCount(), 3u);
+
+    EXPECT_THROW(metricsHandler.SetRollups({0}), std::invalid_argument);
+    EXPECT_THROW(metricsHandler.SetRollups({12}, -2), std::invalid_argument);
+}
+
+TEST(RollupStoreTest, TestRawWindowKeepsWholeRunSummary)
+{
+    const int ticks = 2000;
+    MetricsHandler whole;
+    RecordRun(whole, ticks);
+    MetricsHandler windowed;
+    windowed.SetRollups({}, 12);
+    RecordRun(windowed, ticks);
+
+    // The window only holds the latest samples, the summary still covers the run
+    EXPECT_LT(windowed.GetSeries("Station-1", "MaterialVolume").size(), whole.GetSeries("Station-1", "MaterialVolume").size());
+    std::vector<std::string> summary = Summary(whole);
+    ASSERT_EQ(summary.size(), 6u);
+    EXPECT_EQ(Summary(windowed), summary);
+}
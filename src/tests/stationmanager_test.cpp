@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/stationmanager.h"
+#include <vector>
+#include <algorithm>
+
+TEST(StationManagerTest, TestShortestQueueTiesGoToLowestIndex)
+{
+    StationManager manager(3, 10);
+    // Empty queues tie, so stations fill in index order
+    EXPECT_EQ(manager.AddToShortestQueue(0), 0);
+    EXPECT_EQ(manager.AddToShortestQueue(1), 1);
+    EXPECT_EQ(manager.AddToShortestQueue(2), 2);
+    EXPECT_EQ(manager.AddToShortestQueue(3), 0);
+
+    // Station 1 drops to the shortest queue once popped
+    manager.PopStationQueue(1);
+    EXPECT_EQ(manager.GetStationSize(1), 0u);
+    EXPECT_EQ(manager.AddToShortestQueue(4), 1);
+    EXPECT_EQ(manager.AddToShortestQueue(5), 1);
+    EXPECT_EQ(manager.AddToShortestQueue(6), 2);
+    EXPECT_EQ(manager.GetStationSize(0), 2u);
+    EXPECT_EQ(manager.GetStationSize(1), 2u);
+    EXPECT_EQ(manager.GetStationSize(2), 2u);
+}
+
+TEST(StationManagerTest, TestHeapOrderHoldsAcrossPops)
+{
+    const int stations = 13;
+    StationManager manager(stations, 1000);
+    std::vector<size_t> queued(stations, 0);
+    unsigned int state = 12345;
+    for (int step = 0; step < 2000; step++)
+    {
+        state = state * 1103515245u + 12345u;
+        bool pop = (state >> 16) % 3 == 0;
+        if (pop)
+        {
+            int station = static_cast<int>((state >> 8) % stations);
+            if (queued[station] == 0)
+                continue;
+            manager.PopStationQueue(station);
+            queued[station]--;
+        }
+        else
+        {
+            // The least-loaded station, the lowest index among equals
+            int expected = static_cast<int>(std::min_element(queued.begin(), queued.end()) - queued.begin());
+            ASSERT_EQ(manager.AddToShortestQueue(step), expected) << "step " << step;
+            queued[expected]++;
+        }
+    }
+    for (int station = 0; station < stations; station++)
+        EXPECT_EQ(manager.GetStationSize(station), queued[station]);
+}
+
+TEST(StationManagerTest, TestRejectsMissingStations)
+{
+    StationManager empty(0, 5);
+    EXPECT_THROW(empty.AddToShortestQueue(1), std::runtime_error);
+
+    StationManager manager(2, 5);
+    EXPECT_THROW(manager.PopStationQueue(7), std::invalid_argument);
+    EXPECT_THROW(manager.PopStationQueue(-1), std::invalid_argument);
+    EXPECT_THROW(manager.GetStationSize(7), std::invalid_argument);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/statskernel.h"
+#include <vector>
+#include <algorithm>
+#include <numeric>
+
+TEST(StatsKernelTest, TestSummaryMatchesSeparatePasses)
+{
+    // Lengths around the lane count exercise the tail
+    for (size_t n : {1, 7, 8, 9, 1000, 1003})
+    {
+        std::vector<double> values(n);
+        for (size_t i = 0; i < n; i++)
+            values[i] = static_cast<double>((i * 7919) % 101) - 20.0;
+
+        SeriesSummary summary = StatsKernel::Summarize(values, true);
+        auto [minIt, maxIt] = std::minmax_element(values.begin(), values.end());
+        EXPECT_EQ(summary.count, n);
+        EXPECT_DOUBLE_EQ(summary.sum, std::accumulate(values.begin(), values.end(), 0.0));
+        EXPECT_EQ(summary.min, *minIt);
+        EXPECT_EQ(summary.max, *maxIt);
+        EXPECT_DOUBLE_EQ(summary.sumSquares, std::inner_product(values.begin(), values.end(), values.begin(), 0.0));
+
+        size_t positives = std::count_if(values.begin(), values.end(), [](double v) { return v > 0; });
+        double positiveSum = std::accumulate(values.begin(), values.end(), 0.0, [](double total, double v) { return v > 0 ? total + v : total; });
+        EXPECT_EQ(summary.positiveCount, positives);
+        EXPECT_DOUBLE_EQ(summary.positiveSum, positiveSum);
+    }
+}
+
+TEST(StatsKernelTest, TestSumOfSquaresIsOptional)
+{
+    std::vector<double> values = {1.0, 2.0, 3.0, 4.0};
+    EXPECT_EQ(StatsKernel::Summarize(values).sumSquares, 0.0);
+    SeriesSummary summary = StatsKernel::Summarize(values, true);
+    EXPECT_DOUBLE_EQ(summary.Mean(), 2.5);
+    EXPECT_DOUBLE_EQ(summary.Variance(), 5.0 / 3.0);
+}
+
+TEST(StatsKernelTest, TestPercentilesMatchSortedRanks)
+{
+    std::vector<double> values(1001);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = static_cast<double>((i * 7919) % values.size());
+
+    const double quantiles[] = {0.0, 0.5, 0.9, 0.99, 1.0};
+    double results[5];
+    std::vector<double> scratch = values;
+    StatsKernel::Percentiles(scratch, quantiles, results, 5);
+
+    // The smallest value whose rank reaches q times the count
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(results[0], values[0]);
+    EXPECT_EQ(results[1], values[500]);
+    EXPECT_EQ(results[2], values[900]);
+    EXPECT_EQ(results[3], values[990]);
+    EXPECT_EQ(results[4], values[1000]);
+
+    scratch = values;
+    std::reverse(scratch.begin(), scratch.end());
+    EXPECT_EQ(StatsKernel::Percentile(scratch, 0.9), values[900]);
+    std::vector<double> empty;
+    EXPECT_EQ(StatsKernel::Percentile(empty, 0.5), 0.0);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/streamingstats.h"
+#include <vector>
+#include <algorithm>
+#include <numeric>
+
+class StreamingStatsTest : public ::testing::Test
+{
+    public:
+        // Deterministic shuffled sample set 0..n-1
+        std::vector<double> Samples(int n)
+        {
+            std::vector<double> values(n);
+            for (int i = 0; i < n; i++)
+                values[i] = static_cast<double>((static_cast<long long>(i) * 7919) % n);
+            return values;
+        }
+};
+
+TEST_F(StreamingStatsTest, TestMergedAggregatesMatchSinglePass)
+{
+    std::vector<double> values = Samples(10007);
+    StreamingStats whole;
+    StreamingStats parts[3];
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        whole.Add(values[i]);
+        parts[i % 3].Add(values[i]);
+    }
+    parts[0].Merge(parts[1]);
+    parts[0].Merge(parts[2]);
+
+    EXPECT_EQ(parts[0].GetCount(), whole.GetCount());
+    EXPECT_DOUBLE_EQ(parts[0].GetSum(), whole.GetSum());
+    EXPECT_EQ(parts[0].GetMin(), 0.0);
+    EXPECT_EQ(parts[0].GetMax(), 10006.0);
+    EXPECT_NEAR(parts[0].GetMean(), whole.GetMean(), 1e-9);
+    EXPECT_NEAR(parts[0].GetVariance(), whole.GetVariance(), 1e-6 * whole.GetVariance());
+}
+
+TEST_F(StreamingStatsTest, TestSketchQuantilesStayWithinRankError)
+{
+    const int n = 200000;
+    std::vector<double> values = Samples(n);
+    QuantileSketch whole;
+    QuantileSketch left, right;
+    for (int i = 0; i < n; i++)
+    {
+        whole.Add(values[i]);
+        (i < n / 2 ? left : right).Add(values[i]);
+    }
+    left.Merge(right);
+
+    EXPECT_EQ(whole.GetCount(), static_cast<size_t>(n));
+    EXPECT_LT(whole.GetRetained(), 2000u);
+    for (double q : {0.1, 0.5, 0.9, 0.99})
+    {
+        // Values are the ranks themselves, so the rank error reads directly off the estimate
+        EXPECT_NEAR(whole.Quantile(q), q * n, 0.02 * n);
+        EXPECT_NEAR(left.Quantile(q), q * n, 0.02 * n);
+    }
+}
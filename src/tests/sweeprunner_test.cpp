@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/sweeprunner.h"
+
+TEST(SweepRunnerTest, TestParseRange)
+{
+    EXPECT_EQ(SweepRunner::ParseRange("50"), std::vector<int>({50}));
+    EXPECT_EQ(SweepRunner::ParseRange("5,10,20"), std::vector<int>({5, 10, 20}));
+    EXPECT_EQ(SweepRunner::ParseRange("10:14"), std::vector<int>({10, 11, 12, 13, 14}));
+    EXPECT_EQ(SweepRunner::ParseRange("10:40:10"), std::vector<int>({10, 20, 30, 40}));
+    EXPECT_THROW(SweepRunner::ParseRange("ten"), std::invalid_argument);
+    EXPECT_THROW(SweepRunner::ParseRange("10:5"), std::invalid_argument);
+    EXPECT_THROW(SweepRunner::ParseRange("1:5:0"), std::invalid_argument);
+    EXPECT_THROW(SweepRunner::ParseRange("1,,2"), std::invalid_argument);
+}
+
+TEST(SweepRunnerTest, TestGridIsCoveredInOrder)
+{
+    SweepRunner first({10, 20}, {2, 4}, {24, 48}, 7, 3);
+    SweepRunner again({10, 20}, {2, 4}, {24, 48}, 7, 1);
+    first.SetEngine(TickHandler::EVENT);
+    again.SetEngine(TickHandler::EVENT);
+    first.Run();
+    again.Run();
+
+    const auto &results = first.GetResults();
+    ASSERT_EQ(results.size(), 8u);
+    EXPECT_EQ(results[0].miners, 10);
+    EXPECT_EQ(results[1].horizon, 48);
+    EXPECT_EQ(results[2].stations, 4);
+    EXPECT_EQ(results[7].miners, 20);
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        // Results do not depend on how configurations were spread over workers
+        EXPECT_EQ(results[i].unloads, again.GetResults()[i].unloads);
+        EXPECT_EQ(results[i].avgQueue, again.GetResults()[i].avgQueue);
+        EXPECT_LE(results[i].stationUtilization, 1.0);
+    }
+}
+
+TEST(SweepRunnerTest, TestFailedConfigurationIsReported)
+{
+    // A configuration without stations throws while ticking, the rest of the grid still runs
+    SweepRunner runner({10}, {0, 2}, {24}, 7, 2);
+    runner.Run();
+
+    const auto &results = runner.GetResults();
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_FALSE(results[0].error.empty());
+    EXPECT_EQ(results[0].unloads, 0u);
+    EXPECT_TRUE(results[1].error.empty());
+    EXPECT_EQ(results[1].stations, 2);
+}
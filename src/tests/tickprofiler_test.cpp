@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/tickhandler.h"
+
+TEST(TickProfilerTest, TestEveryTickIsProfiled)
+{
+    for (int engine : {TickHandler::TICK, TickHandler::EVENT})
+    {
+        MetricsHandler metricsHandler;
+        MinerManager minerManager(50, 3);
+        StationManager stationManager(4, 50);
+        TickHandler tickHandler(minerManager, stationManager, 0, 2, metricsHandler);
+        tickHandler.SetEngine(engine);
+        tickHandler.SetHorizon(60);
+        EXPECT_EQ(tickHandler.GetProfiler(), nullptr);
+        tickHandler.EnableProfiling(true);
+        tickHandler.start();
+        tickHandler.wait();
+
+        const TickProfiler *profiler = tickHandler.GetProfiler();
+        ASSERT_NE(profiler, nullptr);
+        EXPECT_EQ(profiler->GetCount(TickProfiler::TICK), 60u);
+        // Every tick handles the fleet in at least one chunk
+        EXPECT_GE(profiler->GetCount(TickProfiler::STATIONS), 60u);
+        EXPECT_EQ(profiler->GetCount(TickProfiler::STATIONS), profiler->GetCount(TickProfiler::MINERS));
+        // Unpaced runs neither sleep nor overrun
+        EXPECT_EQ(profiler->GetCount(TickProfiler::SLEEP), 0u);
+        EXPECT_EQ(profiler->GetOverruns(), 0u);
+        EXPECT_GT(profiler->GetCount(TickProfiler::METRICS), 0u);
+        EXPECT_LE(profiler->GetTotal(TickProfiler::METRICS), profiler->GetTotal(TickProfiler::STATIONS));
+    }
+}
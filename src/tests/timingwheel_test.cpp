@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include "../inlcude/utils/timingwheel.h"
+#include "../inlcude/utils/tickhandler.h"
+#include <vector>
+
+TEST(TimingWheelTest, TestEventsFireOnTheirTickInIdOrder)
+{
+    TimingWheel wheel;
+    wheel.schedule(3, 7);
+    wheel.schedule(3, 2);
+    wheel.schedule(5, 4);
+    wheel.schedule(3, 9);
+    EXPECT_EQ(wheel.size(), 4u);
+
+    std::vector<int> due;
+    wheel.popDue(2, due);
+    EXPECT_TRUE(due.empty());
+    wheel.popDue(3, due);
+    EXPECT_EQ(due, (std::vector<int>{2, 7, 9}));
+    EXPECT_EQ(wheel.size(), 1u);
+
+    // Due IDs are appended, earlier contents stay
+    wheel.popDue(5, due);
+    EXPECT_EQ(due, (std::vector<int>{2, 7, 9, 4}));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimingWheelTest, TestWrapAroundAndMultiLapDelays)
+{
+    TimingWheel wheel;
+    // Same slot, one, two and three rotations apart
+    wheel.schedule(WHEEL_SLOTS - 1, 1);
+    wheel.schedule(2 * WHEEL_SLOTS - 1, 2);
+    wheel.schedule(4 * WHEEL_SLOTS - 1, 3);
+    // Wraps into the first slots of the next rotation
+    wheel.schedule(WHEEL_SLOTS + 1, 4);
+
+    std::vector<int> fired;
+    std::vector<int> firedAt;
+    for (int tick = 0; tick < 4 * WHEEL_SLOTS; tick++)
+    {
+        std::vector<int> due;
+        wheel.popDue(tick, due);
+        for (int id : due)
+        {
+            fired.push_back(id);
+            firedAt.push_back(tick);
+        }
+    }
+    EXPECT_EQ(fired, (std::vector<int>{1, 4, 2, 3}));
+    EXPECT_EQ(firedAt, (std::vector<int>{WHEEL_SLOTS - 1, WHEEL_SLOTS + 1, 2 * WHEEL_SLOTS - 1, 4 * WHEEL_SLOTS - 1}));
+    EXPECT_EQ(wheel.size(), 0u);
+
+    wheel.schedule(10, 1);
+    wheel.clear();
+    std::vector<int> due;
+    wheel.popDue(10, due);
+    EXPECT_TRUE(due.empty());
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimingWheelTest, TestEventEngineMatchesTickEngine)
+{
+    const int miners = 200;
+    auto run = [](int engine, MinerManager &minerManager)
+    {
+        MetricsHandler metricsHandler;
+        // A station per miner, so no miner ever waits. Under contention the tick engine lets a removal reach later
+        // miners within the same tick, while the event engine signals the new front on the next tick
+        StationManager stationManager(miners, miners);
+        TickHandler tickHandler(minerManager, stationManager, 0, 1, metricsHandler);
+        tickHandler.SetEngine(engine);
+        // Longer than a rotation of the wheel
+        tickHandler.SetHorizon(3 * WHEEL_SLOTS + 17);
+        tickHandler.start();
+        tickHandler.wait();
+    };
+    MinerManager ticked(miners, 21);
+    MinerManager evented(miners, 21);
+    run(TickHandler::TICK, ticked);
+    run(TickHandler::EVENT, evented);
+
+    for (int id = 0; id < miners; id++)
+    {
+        Miner expected = ticked.GetMiner(id);
+        Miner actual = evented.GetMiner(id);
+        EXPECT_EQ(actual.GetState(), expected.GetState()) << "miner " << id;
+        EXPECT_EQ(actual.GetTime(), expected.GetTime()) << "miner " << id;
+        EXPECT_EQ(actual.GetMiningTime(), expected.GetMiningTime()) << "miner " << id;
+        EXPECT_EQ(actual.GetQueueStatus(), expected.GetQueueStatus()) << "miner " << id;
+        EXPECT_EQ(actual.GetStationID(), expected.GetStationID()) << "miner " << id;
+        EXPECT_EQ(actual.GetLoad(), expected.GetLoad()) << "miner " << id;
+    }
+}
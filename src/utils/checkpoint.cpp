@@ -0,0 +1,99 @@
+/**
+ * @file checkpoint.cpp
+ * @brief Implementation of CheckpointWriter and CheckpointReader, the binary snapshot of a run.
+ *
+ * Components append their state section by section as plain values and arrays. Restoring maps
+ * the file and copies each array out in a single block, so resuming a large fleet costs about
+ * as much as reading the file rather than re-simulating the ticks that led up to it.
+ */
+
+#include "../inlcude/utils/checkpoint.h"
+
+using namespace std;
+
+/**
+ * @brief Creates a checkpoint file and writes its header.
+ * @param path Path of the file, replaced if it exists.
+ * @throws std::runtime_error if the file cannot be created.
+ */
+CheckpointWriter::CheckpointWriter(const string &path) : file(path, ios::binary | ios::trunc), path(path)
+{
+    if (!file.is_open())
+        throw runtime_error("Unable to open file: " + path);
+    file.write(CHECKPOINT_MAGIC, 8);
+    Write<uint32_t>(CHECKPOINT_VERSION);
+    Write<uint32_t>(0);
+}
+
+/**
+ * @brief Writes a length-prefixed string.
+ * @param text The string.
+ */
+void CheckpointWriter::WriteString(const string &text)
+{
+    Write<uint64_t>(text.size());
+    file.write(text.data(), static_cast<streamsize>(text.size()));
+}
+
+/**
+ * @brief Flushes and closes the file.
+ * @throws std::runtime_error if any write failed.
+ */
+void CheckpointWriter::Close()
+{
+    file.close();
+    if (file.fail())
+        throw runtime_error("Unable to write file: " + path);
+}
+
+/**
+ * @brief Maps a checkpoint file and checks its header.
+ * @param path Path of the file.
+ * @throws std::runtime_error if the file cannot be mapped or is not a checkpoint of this version.
+ */
+CheckpointReader::CheckpointReader(const string &path) : file(path), offset(0)
+{
+    if (file.GetSize() < 16 || memcmp(file.GetData(), CHECKPOINT_MAGIC, 8) != 0)
+        throw runtime_error("Not a checkpoint file: " + path);
+    offset = 8;
+    if (Read<uint32_t>() != CHECKPOINT_VERSION)
+        throw runtime_error("Unsupported checkpoint version: " + path);
+    Read<uint32_t>();
+}
+
+/**
+ * @brief Reads a length-prefixed string.
+ * @return string The string.
+ */
+string CheckpointReader::ReadString()
+{
+    uint64_t length = Read<uint64_t>();
+    if (length > file.GetSize() - offset)
+        throw runtime_error("Truncated checkpoint");
+    const char *text = Take(static_cast<size_t>(length));
+    return string(text, static_cast<size_t>(length));
+}
+
+/**
+ * @brief Checks whether every byte of the file has been read.
+ * @return true If nothing is left.
+ */
+bool CheckpointReader::AtEnd() const
+{
+    return offset == file.GetSize();
+}
+
+/**
+ * @brief Consumes bytes from the mapping.
+ * @param bytes Number of bytes.
+ * @return const char* Start of the consumed bytes.
+ * @throws std::runtime_error if the file ends first.
+ */
+const char *CheckpointReader::Take(size_t bytes)
+{
+    if (bytes > file.GetSize() - offset)
+        throw runtime_error("Truncated checkpoint");
+    const char *data = file.GetData() + offset;
+    offset += bytes;
+    return data;
+}
@@ -0,0 +1,343 @@
+/**
+ * @file columnarfile.cpp
+ * @brief Implementation of ColumnarWriter and ColumnarReader, a compact binary results format.
+ *
+ * Each asset/metric series is stored as one contiguous typed array behind a small index, so a
+ * reader maps the file and hands out columns in place: loading results costs page faults
+ * instead of a parse. Integers are written in host byte order, which is little-endian on every
+ * platform the simulator targets.
+ */
+
+#include "../inlcude/utils/columnarfile.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+using namespace std;
+
+static_assert(sizeof(ColumnarFile::Header) == 32, "Header layout must not depend on the compiler");
+static_assert(sizeof(ColumnarFile::ColumnEntry) == 40, "Column entry layout must not depend on the compiler");
+
+namespace
+{
+    uint64_t aligned(uint64_t offset)
+    {
+        return (offset + COLUMNAR_ALIGNMENT - 1) & ~static_cast<uint64_t>(COLUMNAR_ALIGNMENT - 1);
+    }
+
+    size_t elementSize(int encoding)
+    {
+        return encoding == ColumnarFile::F64 ? sizeof(double) : encoding == ColumnarFile::F32 ? sizeof(float) : sizeof(int32_t);
+    }
+}
+
+/**
+ * @brief Queues a column for writing.
+ * @param asset Asset name, for example "Miner-1".
+ * @param metric Metric name, for example "DistanceTraveled".
+ * @param values The samples. Referenced, not copied, they must stay alive until Write.
+ * @param count Number of samples.
+ * @param encoding One of ColumnarFile::ENCODING.
+ */
+void ColumnarWriter::AddColumn(const string &asset, const string &metric, const double *values, size_t count, int encoding)
+{
+    if (encoding == ColumnarFile::DELTA_I32 && !IsDeltaEncodable(values, count))
+        encoding = ColumnarFile::F64;
+    columns.push_back({asset, metric, values, count, encoding});
+}
+
+/**
+ * @brief Checks whether a column round-trips exactly through 32-bit deltas.
+ * @param values The samples.
+ * @param count Number of samples.
+ * @return true If every value is integral and every step fits in an int32.
+ */
+bool ColumnarWriter::IsDeltaEncodable(const double *values, size_t count)
+{
+    double previous = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        double value = values[i];
+        if (value != floor(value) || fabs(value) > 9007199254740992.0)
+            return false;
+        double delta = value - previous;
+        if (delta < numeric_limits<int32_t>::min() || delta > numeric_limits<int32_t>::max())
+            return false;
+        previous = value;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes every queued column to a file, index first, sorted by asset and metric name.
+ * @param path Path of the file to create.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void ColumnarWriter::Write(const string &path) const
+{
+    vector<const Column *> order;
+    for (const auto &column : columns)
+        order.push_back(&column);
+    stable_sort(order.begin(), order.end(), [](const Column *a, const Column *b)
+                { return tie(a->asset, a->metric) < tie(b->asset, b->metric); });
+
+    ColumnarFile::Header header{};
+    memcpy(header.magic, COLUMNAR_MAGIC, sizeof(header.magic));
+    header.version = COLUMNAR_VERSION;
+    header.columnCount = static_cast<uint32_t>(order.size());
+    header.stringsOffset = sizeof(header) + order.size() * sizeof(ColumnarFile::ColumnEntry);
+
+    string strings;
+    vector<ColumnarFile::ColumnEntry> entries(order.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        entries[i].assetOffset = static_cast<uint32_t>(strings.size());
+        entries[i].assetLength = static_cast<uint32_t>(order[i]->asset.size());
+        strings += order[i]->asset;
+        entries[i].metricOffset = static_cast<uint32_t>(strings.size());
+        entries[i].metricLength = static_cast<uint32_t>(order[i]->metric.size());
+        strings += order[i]->metric;
+        entries[i].encoding = static_cast<uint32_t>(order[i]->encoding);
+        entries[i].count = order[i]->count;
+    }
+    header.stringsSize = strings.size();
+
+    uint64_t offset = aligned(header.stringsOffset + header.stringsSize);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        entries[i].dataOffset = offset;
+        offset = aligned(offset + entries[i].count * elementSize(order[i]->encoding));
+    }
+
+    ofstream file(path, ios::binary);
+    if (!file.is_open())
+    {
+        throw runtime_error("Unable to open file: " + path);
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(ColumnarFile::ColumnEntry));
+    file.write(strings.data(), strings.size());
+
+    const char padding[COLUMNAR_ALIGNMENT] = {};
+    uint64_t written = header.stringsOffset + header.stringsSize;
+    vector<char> buffer;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        file.write(padding, entries[i].dataOffset - written);
+        const Column &column = *order[i];
+        if (column.encoding == ColumnarFile::F64)
+        {
+            file.write(reinterpret_cast<const char *>(column.values), column.count * sizeof(double));
+        }
+        else
+        {
+            buffer.resize(column.count * elementSize(column.encoding));
+            if (column.encoding == ColumnarFile::F32)
+            {
+                float *out = reinterpret_cast<float *>(buffer.data());
+                for (size_t j = 0; j < column.count; j++)
+                    out[j] = static_cast<float>(column.values[j]);
+            }
+            else
+            {
+                int32_t *out = reinterpret_cast<int32_t *>(buffer.data());
+                double previous = 0.0;
+                for (size_t j = 0; j < column.count; j++)
+                {
+                    out[j] = static_cast<int32_t>(column.values[j] - previous);
+                    previous = column.values[j];
+                }
+            }
+            file.write(buffer.data(), buffer.size());
+        }
+        written = entries[i].dataOffset + column.count * elementSize(column.encoding);
+    }
+    if (!file)
+    {
+        throw runtime_error("Unable to write file: " + path);
+    }
+}
+
+/**
+ * @brief Constructs a view over column data that lives in a mapped file.
+ * @param asset Asset name.
+ * @param metric Metric name.
+ * @param encoding One of ColumnarFile::ENCODING.
+ * @param count Number of samples.
+ * @param data Start of the column's array.
+ */
+ColumnView::ColumnView(string_view asset, string_view metric, int encoding, size_t count, const char *data)
+    : asset(asset), metric(metric), encoding(encoding), count(count), data(data)
+{
+}
+
+/**
+ * @brief Returns the asset name of the column.
+ * @return string_view Asset name, backed by the mapped file.
+ */
+string_view ColumnView::GetAsset() const
+{
+    return asset;
+}
+
+/**
+ * @brief Returns the metric name of the column.
+ * @return string_view Metric name, backed by the mapped file.
+ */
+string_view ColumnView::GetMetric() const
+{
+    return metric;
+}
+
+/**
+ * @brief Returns how the column is encoded.
+ * @return int One of ColumnarFile::ENCODING.
+ */
+int ColumnView::GetEncoding() const
+{
+    return encoding;
+}
+
+/**
+ * @brief Returns the number of samples in the column.
+ * @return size_t Sample count.
+ */
+size_t ColumnView::size() const
+{
+    return count;
+}
+
+/**
+ * @brief Accesses an F64 column in place.
+ * @return const double* The samples, nullptr if the column has another encoding.
+ */
+const double *ColumnView::AsF64() const
+{
+    return encoding == ColumnarFile::F64 ? reinterpret_cast<const double *>(data) : nullptr;
+}
+
+/**
+ * @brief Accesses an F32 column in place.
+ * @return const float* The samples, nullptr if the column has another encoding.
+ */
+const float *ColumnView::AsF32() const
+{
+    return encoding == ColumnarFile::F32 ? reinterpret_cast<const float *>(data) : nullptr;
+}
+
+/**
+ * @brief Accesses the raw deltas of a DELTA_I32 column in place.
+ * @return const int32_t* The deltas, the first one relative to zero. nullptr if the column has another encoding.
+ */
+const int32_t *ColumnView::AsDeltas() const
+{
+    return encoding == ColumnarFile::DELTA_I32 ? reinterpret_cast<const int32_t *>(data) : nullptr;
+}
+
+/**
+ * @brief Copies the column out as doubles, whatever its encoding.
+ * @return vector<double> The samples.
+ */
+vector<double> ColumnView::Decode() const
+{
+    vector<double> values(count);
+    if (const double *f64 = AsF64())
+    {
+        copy(f64, f64 + count, values.begin());
+    }
+    else if (const float *f32 = AsF32())
+    {
+        copy(f32, f32 + count, values.begin());
+    }
+    else if (const int32_t *deltas = AsDeltas())
+    {
+        int64_t running = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            running += deltas[i];
+            values[i] = static_cast<double>(running);
+        }
+    }
+    return values;
+}
+
+/**
+ * @brief Maps a columnar file and reads its index. Column data is not touched until used.
+ * @param path Path of the file.
+ * @throws std::runtime_error if the file cannot be mapped or is not a valid columnar file.
+ */
+ColumnarReader::ColumnarReader(const string &path) : file(path)
+{
+    const char *base = file.GetData();
+    size_t size = file.GetSize();
+    ColumnarFile::Header header;
+    if (size < sizeof(header))
+    {
+        throw runtime_error("Not a columnar results file: " + path);
+    }
+    memcpy(&header, base, sizeof(header));
+    if (memcmp(header.magic, COLUMNAR_MAGIC, sizeof(header.magic)) != 0 || header.version != COLUMNAR_VERSION)
+    {
+        throw runtime_error("Not a columnar results file: " + path);
+    }
+    if (header.stringsOffset != sizeof(header) + static_cast<uint64_t>(header.columnCount) * sizeof(ColumnarFile::ColumnEntry) ||
+        header.stringsOffset + header.stringsSize > size)
+    {
+        throw runtime_error("Corrupt columnar index: " + path);
+    }
+
+    const char *strings = base + header.stringsOffset;
+    columns.reserve(header.columnCount);
+    for (uint32_t i = 0; i < header.columnCount; i++)
+    {
+        ColumnarFile::ColumnEntry entry;
+        memcpy(&entry, base + sizeof(header) + i * sizeof(entry), sizeof(entry));
+        if (entry.encoding > ColumnarFile::DELTA_I32 ||
+            static_cast<uint64_t>(entry.assetOffset) + entry.assetLength > header.stringsSize ||
+            static_cast<uint64_t>(entry.metricOffset) + entry.metricLength > header.stringsSize ||
+            entry.dataOffset % COLUMNAR_ALIGNMENT != 0 || entry.dataOffset > size ||
+            entry.count > (size - entry.dataOffset) / elementSize(entry.encoding))
+        {
+            throw runtime_error("Corrupt columnar index: " + path);
+        }
+        columns.emplace_back(string_view(strings + entry.assetOffset, entry.assetLength),
+                             string_view(strings + entry.metricOffset, entry.metricLength),
+                             static_cast<int>(entry.encoding), entry.count, base + entry.dataOffset);
+    }
+}
+
+/**
+ * @brief Returns the number of columns in the file.
+ * @return size_t Column count.
+ */
+size_t ColumnarReader::GetColumnCount() const
+{
+    return columns.size();
+}
+
+/**
+ * @brief Accesses a column by its position in the index.
+ * @param index Position, columns are sorted by asset then metric name.
+ * @return const ColumnView& The column.
+ * @throws std::out_of_range if index is past the last column.
+ */
+const ColumnView &ColumnarReader::GetColumn(size_t index) const
+{
+    return columns.at(index);
+}
+
+/**
+ * @brief Looks a column up by name with a binary search over the sorted index.
+ * @param asset Asset name.
+ * @param metric Metric name.
+ * @return const ColumnView* The column, nullptr if the file has no such column.
+ */
+const ColumnView *ColumnarReader::Find(string_view asset, string_view metric) const
+{
+    auto it = lower_bound(columns.begin(), columns.end(), make_pair(asset, metric), [](const ColumnView &column, const pair<string_view, string_view> &key)
+                          { return make_pair(column.GetAsset(), column.GetMetric()) < key; });
+    if (it != columns.end() && it->GetAsset() == asset && it->GetMetric() == metric)
+        return &*it;
+    return nullptr;
+}
@@ -0,0 +1,426 @@
+/**
+ * @file distributedrunner.cpp
+ * @brief Implementation of DistributedRunner and DistributedWorker, a lockstep run split across processes.
+ *
+ * The coordinator forks one worker per slice of the fleet and talks to each over a Unix domain
+ * socket pair. Every tick follows the lockstep engine of TickHandler: workers decide against the
+ * station fronts frozen at the start of the tick and send their station requests and metric samples
+ * in one message, the coordinator commits the requests of all slices in miner ID order, then
+ * answers each worker with the outcome of its enqueues and the new fronts in one message. Workers
+ * then run their transitions. Since the order of every update is fixed by miner IDs, the run
+ * records the same metrics as a single-process lockstep run with the same seed.
+ */
+
+#include "../inlcude/utils/distributedrunner.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+using namespace std;
+
+namespace
+{
+    // Every message is a byte count followed by a sequence of arrays, each prefixed by its element count
+    template <typename T>
+    void Append(vector<char> &buffer, const vector<T> &values)
+    {
+        uint32_t count = static_cast<uint32_t>(values.size());
+        size_t offset = buffer.size();
+        buffer.resize(offset + sizeof(count) + values.size() * sizeof(T));
+        memcpy(buffer.data() + offset, &count, sizeof(count));
+        if (!values.empty())
+            memcpy(buffer.data() + offset + sizeof(count), values.data(), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    size_t Extract(const vector<char> &buffer, size_t offset, vector<T> &values)
+    {
+        uint32_t count;
+        if (offset + sizeof(count) > buffer.size())
+            throw runtime_error("Truncated message from a distributed peer");
+        memcpy(&count, buffer.data() + offset, sizeof(count));
+        offset += sizeof(count);
+        if (offset + static_cast<size_t>(count) * sizeof(T) > buffer.size())
+            throw runtime_error("Truncated message from a distributed peer");
+        values.resize(count);
+        if (count > 0)
+            memcpy(values.data(), buffer.data() + offset, static_cast<size_t>(count) * sizeof(T));
+        return offset + static_cast<size_t>(count) * sizeof(T);
+    }
+
+#ifndef _WIN32
+#ifdef MSG_NOSIGNAL
+    const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    const int SEND_FLAGS = 0;
+#endif
+
+    void SendMessage(intptr_t socket, vector<char> &buffer)
+    {
+        uint32_t size = static_cast<uint32_t>(buffer.size() - sizeof(size));
+        memcpy(buffer.data(), &size, sizeof(size));
+        size_t sent = 0;
+        while (sent < buffer.size())
+        {
+            auto result = send(static_cast<int>(socket), buffer.data() + sent, buffer.size() - sent, SEND_FLAGS);
+            if (result <= 0)
+                throw runtime_error("Lost connection to a distributed peer");
+            sent += static_cast<size_t>(result);
+        }
+    }
+
+    void ReceiveAll(intptr_t socket, char *data, size_t size)
+    {
+        size_t received = 0;
+        while (received < size)
+        {
+            auto result = recv(static_cast<int>(socket), data + received, size - received, 0);
+            if (result <= 0)
+                throw runtime_error("Lost connection to a distributed peer");
+            received += static_cast<size_t>(result);
+        }
+    }
+
+    void ReceiveMessage(intptr_t socket, vector<char> &buffer)
+    {
+        uint32_t size;
+        ReceiveAll(socket, reinterpret_cast<char *>(&size), sizeof(size));
+        buffer.resize(size);
+        ReceiveAll(socket, buffer.data(), size);
+    }
+#endif
+
+    // A message under construction starts with room for its byte count
+    void Begin(vector<char> &buffer)
+    {
+        buffer.assign(sizeof(uint32_t), 0);
+    }
+}
+
+/**
+ * @brief Constructs a distributed run. Worker processes are only started by Run().
+ * @param miners Number of miners, split into contiguous slices of nearly equal size.
+ * @param stations Number of stations, kept by the coordinator.
+ * @param seed Master seed of the run's random streams.
+ * @param processes Number of worker processes, at most one per miner.
+ * @param metricsHandler Handler the run's metrics are recorded into.
+ * @throws std::invalid_argument if there are no miners, stations or processes.
+ */
+DistributedRunner::DistributedRunner(int miners, int stations, uint64_t seed, int processes, MetricsHandler &metricsHandler)
+    : miners(miners), processes(min(processes, miners)), seed(seed), horizon(MAX_TICK), stationManager(stations, miners), metricsHandler(metricsHandler)
+{
+    if (miners <= 0 || stations <= 0 || processes <= 0)
+        throw invalid_argument("A distributed run needs miners, stations and worker processes");
+
+    for (int id = 0; id < stations; id++)
+        stationStreams.emplace_back(seed, RandomStream::Entity(RandomStream::STATION_METRICS, id));
+
+    // The same names as TickHandler registers, so both runs produce the same output
+    for (int metric = 0; metric < TickHandler::METRIC_COUNT; metric++)
+        metricIds[metric] = metricsHandler.RegisterMetric(TickHandler::GetMetricName(metric));
+    for (int id = 0; id < miners; id++)
+        minerAssets.push_back(metricsHandler.RegisterAsset("Miner-" + to_string(id + 1)));
+    for (int id = 0; id < stations; id++)
+        stationAssets.push_back(metricsHandler.RegisterAsset("Station-" + to_string(id + 1)));
+}
+
+/**
+ * @brief Destructor, disconnects and reaps any worker still running.
+ */
+DistributedRunner::~DistributedRunner()
+{
+    try
+    {
+        reap();
+    }
+    catch (const exception &)
+    {
+    }
+}
+
+/**
+ * @brief Sets the number of ticks the next Run() simulates.
+ * @param ticks Horizon in ticks, MAX_TICK by default.
+ */
+void DistributedRunner::SetHorizon(int ticks)
+{
+    horizon = ticks;
+}
+
+/**
+ * @brief Returns the number of ticks a run simulates.
+ * @return int Horizon in ticks.
+ */
+int DistributedRunner::GetHorizon() const
+{
+    return horizon;
+}
+
+/**
+ * @brief Starts the worker processes, coordinates them tick by tick up to the horizon and waits for them to exit.
+ * @throws std::runtime_error if a worker cannot be started, disconnects or fails.
+ */
+void DistributedRunner::Run()
+{
+#ifdef _WIN32
+    throw runtime_error("Distributed runs need a POSIX system");
+#else
+    launch();
+
+    // Each worker learns its slice and the starting fronts
+    vector<char> buffer;
+    vector<int32_t> front;
+    readFronts(front);
+    for (int w = 0; w < processes; w++)
+    {
+        int first = static_cast<int>(static_cast<long long>(miners) * w / processes);
+        int last = static_cast<int>(static_cast<long long>(miners) * (w + 1) / processes);
+        Begin(buffer);
+        Append(buffer, vector<uint64_t>{seed, static_cast<uint64_t>(first), static_cast<uint64_t>(last - first), static_cast<uint64_t>(horizon)});
+        Append(buffer, front);
+        SendMessage(sockets[w], buffer);
+    }
+
+    vector<DistributedRequest> requests;
+    vector<DistributedSample> samples;
+    vector<vector<DistributedResult>> results(processes);
+    for (int tick = 0; tick < horizon; tick++)
+    {
+        // Slices arrive in ID order and each lists its requests in ID order, so commits follow miner IDs
+        for (int w = 0; w < processes; w++)
+        {
+            ReceiveMessage(sockets[w], buffer);
+            size_t offset = Extract(buffer, 0, requests);
+            Extract(buffer, offset, samples);
+            for (const auto &sample : samples)
+                metricsHandler.RecordMetric(minerAssets[sample.id], metricIds[sample.metric], sample.value, tick);
+            commit(requests, tick, results[w]);
+        }
+
+        readFronts(front);
+        for (int w = 0; w < processes; w++)
+        {
+            Begin(buffer);
+            Append(buffer, results[w]);
+            Append(buffer, front);
+            SendMessage(sockets[w], buffer);
+        }
+    }
+
+    reap();
+#endif
+}
+
+/**
+ * @brief Forks one worker process per slice, each connected to the coordinator by its own socket pair.
+ * @throws std::runtime_error if a socket pair or process cannot be created.
+ */
+void DistributedRunner::launch()
+{
+#ifndef _WIN32
+    reap();
+    for (int w = 0; w < processes; w++)
+    {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+            throw runtime_error("Could not create a socket pair for a worker process");
+
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            close(pair[0]);
+            close(pair[1]);
+            throw runtime_error("Could not start a worker process");
+        }
+        if (pid == 0)
+        {
+            // The worker only keeps its own end, so it sees the coordinator go away
+            close(pair[0]);
+            for (intptr_t socket : sockets)
+                close(static_cast<int>(socket));
+            int status = 0;
+            try
+            {
+                DistributedWorker(pair[1]).Run();
+            }
+            catch (const exception &)
+            {
+                status = 1;
+            }
+            _exit(status);
+        }
+
+        close(pair[1]);
+        sockets.push_back(pair[0]);
+        pids.push_back(pid);
+    }
+#endif
+}
+
+/**
+ * @brief Closes the workers' sockets and waits for them to exit.
+ * @throws std::runtime_error if a worker exited with a failure.
+ */
+void DistributedRunner::reap()
+{
+#ifndef _WIN32
+    for (intptr_t socket : sockets)
+        close(static_cast<int>(socket));
+    sockets.clear();
+
+    bool failed = false;
+    for (long pid : pids)
+    {
+        int status = 0;
+        if (waitpid(static_cast<pid_t>(pid), &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed = true;
+    }
+    pids.clear();
+    if (failed)
+        throw runtime_error("A worker process failed");
+#endif
+}
+
+/**
+ * @brief Applies the station requests of one slice and records the station metrics of the unloads among them.
+ * @param requests Requests of the slice, in miner ID order.
+ * @param tick Current tick.
+ * @param results Receives the station and queue status of every miner that enqueued.
+ */
+void DistributedRunner::commit(const vector<DistributedRequest> &requests, int tick, vector<DistributedResult> &results)
+{
+    results.clear();
+    for (const auto &request : requests)
+    {
+        if (request.station < 0)
+        {
+            auto targetStation = stationManager.GetStation(stationManager.AddToShortestQueue(request.id));
+            int status = targetStation->isEmpty() ? Miner::FRONT : Miner::QUEUED;
+            results.push_back({request.id, targetStation->GetID(), status});
+            continue;
+        }
+
+        int asset = stationAssets[request.station];
+        auto station = stationManager.GetStation(request.station);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::QUEUE_TIMES], static_cast<double>(station->size()), tick);
+        double materialQuality = stationStreams[request.station].Uniform(0.75, 1.0);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::MATERIAL_VOLUME], request.load, tick);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::MATERIAL_QUALITY], materialQuality, tick);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::UTILIZATION_RATE], 1, tick);
+        stationManager.PopStationQueue(request.station);
+    }
+}
+
+/**
+ * @brief Reads the miner at the front of every station queue, the only station state workers decide on.
+ * @param front Receives the front miner ID of each station, -1 for an empty queue.
+ */
+void DistributedRunner::readFronts(vector<int32_t> &front)
+{
+    front.resize(stationManager.GetAssets());
+    for (int id = 0; id < stationManager.GetAssets(); id++)
+        front[id] = stationManager.GetStation(id)->front();
+}
+
+/**
+ * @brief Constructs a worker talking to its coordinator over a connected socket.
+ * @param socket The worker's end of the connection.
+ */
+DistributedWorker::DistributedWorker(intptr_t socket) : socket(socket)
+{
+}
+
+/**
+ * @brief Receives the worker's slice, then simulates it tick by tick until the coordinator's horizon.
+ * @throws std::runtime_error if the connection to the coordinator is lost.
+ */
+void DistributedWorker::Run()
+{
+#ifdef _WIN32
+    throw runtime_error("Distributed runs need a POSIX system");
+#else
+    vector<char> buffer;
+    vector<uint64_t> config;
+    ReceiveMessage(socket, buffer);
+    size_t offset = Extract(buffer, 0, config);
+    Extract(buffer, offset, front);
+    if (config.size() != 4)
+        throw runtime_error("Malformed configuration from the coordinator");
+
+    uint64_t seed = config[0];
+    int first = static_cast<int>(config[1]);
+    int count = static_cast<int>(config[2]);
+    int horizon = static_cast<int>(config[3]);
+    minerManager = make_unique<MinerManager>(count, seed, first);
+    minerStreams.clear();
+    for (int id = first; id < first + count; id++)
+        minerStreams.emplace_back(seed, RandomStream::Entity(RandomStream::MINER_METRICS, id));
+
+    for (int tick = 0; tick < horizon; tick++)
+    {
+        decide();
+        Begin(buffer);
+        Append(buffer, requests);
+        Append(buffer, samples);
+        SendMessage(socket, buffer);
+
+        ReceiveMessage(socket, buffer);
+        offset = Extract(buffer, 0, results);
+        Extract(buffer, offset, front);
+        for (const auto &result : results)
+        {
+            minerManager->SetStation(result.id - first, result.station);
+            minerManager->SetQueueStatus(result.id - first, result.queueStatus);
+        }
+        minerManager->TickBlock(0, count);
+    }
+#endif
+}
+
+/**
+ * @brief Runs the decide phase for the worker's slice against the fronts of the current tick.
+ * Mirrors TickHandler::decide, with the station reads served from the fronts and the metrics sent as samples.
+ */
+void DistributedWorker::decide()
+{
+    requests.clear();
+    samples.clear();
+    int first = minerManager->GetFirst();
+    const int *states = minerManager->GetStates();
+    for (int index = 0; index < minerManager->GetAssets(); index++)
+    {
+        int id = first + index;
+        switch (states[index])
+        {
+            case Miner::SEARCHING:
+                requests.push_back({id, -1, 0.0});
+                break;
+            case Miner::WAITING:
+            {
+                int station = minerManager->GetStationID(index);
+                if (station >= 0 && station < static_cast<int>(front.size()) && front[station] == id)
+                    minerManager->SetQueueStatus(index, Miner::READY);
+                break;
+            }
+            case Miner::UNLOADING:
+            {
+                if (minerManager->GetQueueStatus(index) == Miner::COMPLETE)
+                {
+                    Miner miner = minerManager->GetMiner(index);
+                    double fuelConsumption = minerStreams[index].Uniform(0.0, 0.02);
+                    samples.push_back({id, TickHandler::DISTANCE_TRAVELED, 1.0});
+                    samples.push_back({id, TickHandler::LOAD_CAPACITY_UTILIZED, miner.GetLoad()});
+                    samples.push_back({id, TickHandler::FUEL_CONSUMPTION, fuelConsumption});
+                    samples.push_back({id, TickHandler::MINING_TIME, static_cast<double>(miner.GetMiningTime())});
+                    requests.push_back({id, miner.GetStationID(), miner.GetLoad()});
+                }
+                break;
+            }
+        }
+    }
+}
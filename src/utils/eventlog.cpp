@@ -0,0 +1,292 @@
+/**
+ * @file eventlog.cpp
+ * @brief Implementation of EventLog and EventLogReader, the binary event stream of a run.
+ *
+ * While a log is attached, workers record what happens to miners and stations as fixed-size
+ * events into their own preallocated arena instead of recording metric samples. Between ticks
+ * the timer thread appends every arena to the file, so the file is ordered by tick and an arena
+ * only ever holds one tick. Replaying a log recomputes the metrics, including the random metric
+ * draws, which start from the stream positions saved in the header.
+ */
+
+#include "../inlcude/utils/eventlog.h"
+#include "../inlcude/utils/tickhandler.h"
+#include <cstring>
+
+using namespace std;
+
+namespace
+{
+    const size_t HEADER_BYTES = 40;
+
+    template <typename T>
+    void WriteValue(ofstream &file, const T &value)
+    {
+        file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T ReadValue(const char *data, size_t &offset)
+    {
+        T value;
+        memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+}
+
+/**
+ * @brief Creates a log file and an arena per worker.
+ * @param path Path of the file, replaced if it exists.
+ * @param arenas Number of arenas, one per worker that records.
+ * @param capacity Initial events per arena.
+ * @throws std::runtime_error if the file cannot be created.
+ */
+EventLog::EventLog(const string &path, unsigned int arenas, size_t capacity) : file(path, ios::binary | ios::trunc), path(path), written(0)
+{
+    if (!file.is_open())
+        throw runtime_error("Unable to open file: " + path);
+    for (unsigned int a = 0; a < max(1u, arenas); a++)
+    {
+        this->arenas.push_back(make_unique<Arena>());
+        this->arenas.back()->events.resize(max<size_t>(1, capacity));
+    }
+}
+
+/**
+ * @brief Destructor, writes out what is left in the arenas.
+ */
+EventLog::~EventLog()
+{
+    try
+    {
+        Close();
+    }
+    catch (const exception &)
+    {
+    }
+}
+
+/**
+ * @brief Writes the header. Called once, before the first event is flushed.
+ * @param seed Master seed of the run.
+ * @param firstTick First tick the log covers.
+ * @param minerCounters Position of every miner's metric stream at the first tick.
+ * @param stationCounters Position of every station's metric stream at the first tick.
+ */
+void EventLog::Begin(uint64_t seed, int firstTick, const vector<uint64_t> &minerCounters, const vector<uint64_t> &stationCounters)
+{
+    file.write(EVENTLOG_MAGIC, 8);
+    WriteValue<uint32_t>(file, EVENTLOG_VERSION);
+    WriteValue<uint32_t>(file, 0);
+    WriteValue<uint64_t>(file, seed);
+    WriteValue<int32_t>(file, static_cast<int32_t>(minerCounters.size()));
+    WriteValue<int32_t>(file, static_cast<int32_t>(stationCounters.size()));
+    WriteValue<int32_t>(file, firstTick);
+    WriteValue<int32_t>(file, 0);
+    for (const auto *counters : {&minerCounters, &stationCounters})
+    {
+        WriteValue<uint64_t>(file, counters->size());
+        file.write(reinterpret_cast<const char *>(counters->data()), static_cast<streamsize>(counters->size() * sizeof(uint64_t)));
+    }
+}
+
+/**
+ * @brief Appends the events of every arena to the file, arena by arena, and empties the arenas.
+ * Only call between ticks, while no worker records.
+ */
+void EventLog::Flush()
+{
+    for (auto &arena : arenas)
+    {
+        if (arena->count == 0)
+            continue;
+        file.write(reinterpret_cast<const char *>(arena->events.data()), static_cast<streamsize>(arena->count * sizeof(Event)));
+        written += arena->count;
+        arena->count = 0;
+    }
+}
+
+/**
+ * @brief Flushes the arenas and closes the file.
+ * @throws std::runtime_error if any write failed.
+ */
+void EventLog::Close()
+{
+    if (!file.is_open())
+        return;
+    Flush();
+    file.close();
+    if (file.fail())
+        throw runtime_error("Unable to write file: " + path);
+}
+
+/**
+ * @brief Returns the number of arenas, the highest worker index that may record is one less.
+ * @return unsigned int Arena count.
+ */
+unsigned int EventLog::GetArenas() const
+{
+    return static_cast<unsigned int>(arenas.size());
+}
+
+/**
+ * @brief Returns the number of events written to the file so far.
+ * @return uint64_t Event count.
+ */
+uint64_t EventLog::GetCount() const
+{
+    return written;
+}
+
+/**
+ * @brief Maps a log file and reads its header.
+ * @param path Path of the file.
+ * @throws std::runtime_error if the file is not an event log of this version or is truncated.
+ */
+EventLogReader::EventLogReader(const string &path) : file(path), events(nullptr), count(0)
+{
+    const char *data = file.GetData();
+    if (file.GetSize() < HEADER_BYTES || memcmp(data, EVENTLOG_MAGIC, 8) != 0)
+        throw runtime_error("Not an event log: " + path);
+    size_t offset = 8;
+    if (ReadValue<uint32_t>(data, offset) != EVENTLOG_VERSION)
+        throw runtime_error("Unsupported event log version: " + path);
+    ReadValue<uint32_t>(data, offset);
+    seed = ReadValue<uint64_t>(data, offset);
+    miners = ReadValue<int32_t>(data, offset);
+    stations = ReadValue<int32_t>(data, offset);
+    firstTick = ReadValue<int32_t>(data, offset);
+    ReadValue<int32_t>(data, offset);
+
+    for (auto *counters : {&minerCounters, &stationCounters})
+    {
+        if (file.GetSize() - offset < sizeof(uint64_t))
+            throw runtime_error("Truncated event log: " + path);
+        uint64_t size = ReadValue<uint64_t>(data, offset);
+        if (size > (file.GetSize() - offset) / sizeof(uint64_t))
+            throw runtime_error("Truncated event log: " + path);
+        counters->resize(static_cast<size_t>(size));
+        memcpy(counters->data(), data + offset, counters->size() * sizeof(uint64_t));
+        offset += counters->size() * sizeof(uint64_t);
+    }
+    if (minerCounters.size() != static_cast<size_t>(miners) || stationCounters.size() != static_cast<size_t>(stations) ||
+        (file.GetSize() - offset) % sizeof(EventLog::Event) != 0)
+        throw runtime_error("Corrupt event log: " + path);
+
+    count = (file.GetSize() - offset) / sizeof(EventLog::Event);
+    events = reinterpret_cast<const EventLog::Event *>(data + offset);
+}
+
+/**
+ * @brief Returns the master seed of the logged run.
+ * @return uint64_t Seed.
+ */
+uint64_t EventLogReader::GetSeed() const
+{
+    return seed;
+}
+
+/**
+ * @brief Returns the number of miners of the logged run.
+ * @return int Miner count.
+ */
+int EventLogReader::GetMiners() const
+{
+    return miners;
+}
+
+/**
+ * @brief Returns the number of stations of the logged run.
+ * @return int Station count.
+ */
+int EventLogReader::GetStations() const
+{
+    return stations;
+}
+
+/**
+ * @brief Returns the first tick the log covers, later than 0 for a run resumed from a checkpoint.
+ * @return int First tick.
+ */
+int EventLogReader::GetFirstTick() const
+{
+    return firstTick;
+}
+
+/**
+ * @brief Returns the number of events in the log.
+ * @return size_t Event count.
+ */
+size_t EventLogReader::GetCount() const
+{
+    return count;
+}
+
+/**
+ * @brief Returns the first event, in the mapped file.
+ * @return const EventLog::Event* First event.
+ */
+const EventLog::Event *EventLogReader::begin() const
+{
+    return events;
+}
+
+/**
+ * @brief Returns one past the last event.
+ * @return const EventLog::Event* End of the events.
+ */
+const EventLog::Event *EventLogReader::end() const
+{
+    return events + count;
+}
+
+/**
+ * @brief Recomputes the miner and station metrics of the logged run from its unloads.
+ *
+ * Every unload yields the samples TickHandler records for it. The fuel consumption and material
+ * quality draws come from the same streams, resumed at the positions saved in the header, and a
+ * miner or station sees its unloads in tick order, so the samples equal those of the run.
+ *
+ * @param metricsHandler Handler the metrics are recorded into.
+ */
+void EventLogReader::Replay(MetricsHandler &metricsHandler) const
+{
+    int metricIds[TickHandler::METRIC_COUNT];
+    for (int metric = 0; metric < TickHandler::METRIC_COUNT; metric++)
+        metricIds[metric] = metricsHandler.RegisterMetric(TickHandler::GetMetricName(metric));
+    vector<int> minerAssets, stationAssets;
+    vector<RandomStream> minerStreams, stationStreams;
+    for (int id = 0; id < miners; id++)
+    {
+        minerAssets.push_back(metricsHandler.RegisterAsset("Miner-" + to_string(id + 1)));
+        minerStreams.emplace_back(seed, RandomStream::Entity(RandomStream::MINER_METRICS, id), minerCounters[id]);
+    }
+    for (int id = 0; id < stations; id++)
+    {
+        stationAssets.push_back(metricsHandler.RegisterAsset("Station-" + to_string(id + 1)));
+        stationStreams.emplace_back(seed, RandomStream::Entity(RandomStream::STATION_METRICS, id), stationCounters[id]);
+    }
+
+    for (const auto &event : *this)
+    {
+        if (event.type != EventLog::UNLOAD)
+            continue;
+        if (event.miner < 0 || event.miner >= miners || event.station < 0 || event.station >= stations)
+            throw runtime_error("Corrupt event log");
+
+        int asset = minerAssets[event.miner];
+        double fuelConsumption = minerStreams[event.miner].Uniform(0.0, 0.02);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::DISTANCE_TRAVELED], 1.0, event.tick);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::LOAD_CAPACITY_UTILIZED], event.load, event.tick);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::FUEL_CONSUMPTION], fuelConsumption, event.tick);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::MINING_TIME], event.cycle, event.tick);
+
+        asset = stationAssets[event.station];
+        double materialQuality = stationStreams[event.station].Uniform(0.75, 1.0);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::QUEUE_TIMES], event.queue, event.tick);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::MATERIAL_VOLUME], event.load, event.tick);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::MATERIAL_QUALITY], materialQuality, event.tick);
+        metricsHandler.RecordMetric(asset, metricIds[TickHandler::UTILIZATION_RATE], 1, event.tick);
+    }
+}
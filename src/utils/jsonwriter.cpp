@@ -0,0 +1,226 @@
+/**
+ * @file jsonwriter.cpp
+ * @brief Implementation of JsonWriter, a buffered writer for JSON text.
+ *
+ * Numbers are formatted directly into the output buffer, so writing a sample allocates nothing.
+ * The text matches nlohmann::json's dump(4): four-space indentation, and doubles in shortest
+ * round-trip form laid out as nlohmann's serializer lays them out. That writes integral values
+ * as "1.0", uses exponents like "1e-05" only below 1e-4 or from 1e15 up, and writes non-finite
+ * values as null. For a few doubles nlohmann's Grisu2 digits are not the shortest and differ in
+ * the last place, both parse back to the same double.
+ */
+
+#include "../inlcude/utils/jsonwriter.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * @brief Opens the file to write to.
+ * @param path Path of the file to create.
+ */
+JsonWriter::JsonWriter(const string &path) : file(path, ios::binary), buffer(JSON_BUFFER_SIZE), used(0)
+{
+}
+
+/**
+ * @brief Flushes whatever is still buffered.
+ */
+JsonWriter::~JsonWriter()
+{
+    Flush();
+}
+
+/**
+ * @brief Checks whether the file was opened.
+ * @return true If the file can be written.
+ */
+bool JsonWriter::IsOpen() const
+{
+    return file.is_open();
+}
+
+/**
+ * @brief Returns room for the given number of bytes, flushing the buffer first if needed.
+ * @param bytes Number of bytes about to be written, at most JSON_BUFFER_SIZE.
+ * @return char* Where to write them.
+ */
+char *JsonWriter::Reserve(size_t bytes)
+{
+    if (used + bytes > buffer.size())
+        Flush();
+    return buffer.data() + used;
+}
+
+/**
+ * @brief Writes text as is.
+ * @param text Text, for example punctuation.
+ */
+void JsonWriter::Raw(string_view text)
+{
+    while (!text.empty())
+    {
+        size_t chunk = min(text.size(), buffer.size());
+        memcpy(Reserve(chunk), text.data(), chunk);
+        used += chunk;
+        text.remove_prefix(chunk);
+    }
+}
+
+/**
+ * @brief Starts a new line indented to the given depth.
+ * @param depth Nesting depth, four spaces each.
+ */
+void JsonWriter::Indent(int depth)
+{
+    size_t width = 1 + 4 * static_cast<size_t>(depth);
+    char *out = Reserve(width);
+    out[0] = '\n';
+    memset(out + 1, ' ', width - 1);
+    used += width;
+}
+
+/**
+ * @brief Writes a quoted string, escaping quotes, backslashes and control characters.
+ * @param text The string.
+ */
+void JsonWriter::String(string_view text)
+{
+    static const char hex[] = "0123456789abcdef";
+    Raw("\"");
+    for (char c : text)
+    {
+        // Worst case is a six-character \u escape
+        char *out = Reserve(6);
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+        {
+            out[0] = '\\';
+            out[1] = c;
+            used += 2;
+        }
+        else if (u < 0x20)
+        {
+            memcpy(out, "\\u00", 4);
+            out[4] = hex[u >> 4];
+            out[5] = hex[u & 0xF];
+            used += 6;
+        }
+        else
+        {
+            out[0] = c;
+            used += 1;
+        }
+    }
+    Raw("\"");
+}
+
+/**
+ * @brief Writes a number in round-trip form, formatted as nlohmann::json's dump writes it.
+ * @param value The number. NaN and infinities are written as null.
+ */
+void JsonWriter::Number(double value)
+{
+    if (!isfinite(value))
+    {
+        Raw("null");
+        return;
+    }
+    // Shortest round-trip digits in scientific form, e.g. "-1.2345e+02"
+    char text[32];
+    char *textEnd = to_chars(text, text + sizeof(text), value, chars_format::scientific).ptr;
+    char *mark = find(text, textEnd, 'e');
+    int exponent = 0;
+    from_chars(mark + (mark[1] == '+' ? 2 : 1), textEnd, exponent);
+    char digits[20];
+    int count = 0;
+    for (const char *c = text; c != mark; c++)
+    {
+        if (*c >= '0' && *c <= '9')
+            digits[count++] = *c;
+    }
+    // Position of the decimal point relative to the digits
+    int point = exponent + 1;
+
+    // The longest output is a sign, 17 digits, 15 zeros, a point and a digit
+    char *out = Reserve(40);
+    char *start = out;
+    if (value < 0 || (value == 0 && signbit(value)))
+        *out++ = '-';
+    if (count <= point && point <= 15)
+    {
+        // 1234 and 1234000 as 1234.0 and 1234000.0
+        out = copy(digits, digits + count, out);
+        out = fill_n(out, point - count, '0');
+        out = copy_n(".0", 2, out);
+    }
+    else if (0 < point && point <= 15)
+    {
+        // 12.34
+        out = copy(digits, digits + point, out);
+        *out++ = '.';
+        out = copy(digits + point, digits + count, out);
+    }
+    else if (-4 < point && point <= 0)
+    {
+        // 0.001234
+        out = copy_n("0.", 2, out);
+        out = fill_n(out, -point, '0');
+        out = copy(digits, digits + count, out);
+    }
+    else
+    {
+        // 1.234e-05 and 1e+20, the exponent has a sign and at least two digits
+        *out++ = digits[0];
+        if (count > 1)
+        {
+            *out++ = '.';
+            out = copy(digits + 1, digits + count, out);
+        }
+        *out++ = 'e';
+        *out++ = exponent < 0 ? '-' : '+';
+        int magnitude = abs(exponent);
+        if (magnitude < 10)
+            *out++ = '0';
+        out = to_chars(out, out + 4, magnitude).ptr;
+    }
+    used += out - start;
+}
+
+/**
+ * @brief Writes an integer.
+ * @param value The integer.
+ */
+void JsonWriter::Integer(long long value)
+{
+    char *out = Reserve(24);
+    used += to_chars(out, out + 24, value).ptr - out;
+}
+
+/**
+ * @brief Writes an unsigned integer, for example a 64-bit seed.
+ * @param value The integer.
+ */
+void JsonWriter::Unsigned(unsigned long long value)
+{
+    char *out = Reserve(24);
+    used += to_chars(out, out + 24, value).ptr - out;
+}
+
+/**
+ * @brief Writes the buffered text to the file and flushes the stream, so it reaches the file even if the process is killed later.
+ * @return true If everything written so far reached the file.
+ */
+bool JsonWriter::Flush()
+{
+    if (used > 0 && file.is_open())
+    {
+        file.write(buffer.data(), used);
+        file.flush();
+    }
+    used = 0;
+    return file.is_open() && file.good();
+}
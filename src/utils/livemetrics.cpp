@@ -0,0 +1,144 @@
+/**
+ * @file livemetrics.cpp
+ * @brief Implementation of LiveMetrics, the counters a metrics server exposes while a run is in progress.
+ *
+ * Workers only ever bump relaxed atomic counters, so exposing a run puts no lock on the tick
+ * path. Counts that would need a pass over the fleet, miners per state and queue depths, are
+ * published by the timer thread between ticks, and only after a scrape has asked for them, so
+ * a run nobody is watching pays nothing for them.
+ */
+
+#include "../inlcude/utils/livemetrics.h"
+#include <sstream>
+
+using namespace std;
+
+namespace
+{
+    // Indexed by Miner::STATES
+    const char *const STATE_NAMES[] = {"mining", "searching", "return", "waiting", "unloading"};
+
+    int64_t Now()
+    {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+/**
+ * @brief Constructs zeroed counters.
+ * @param stations Number of stations of the run.
+ */
+LiveMetrics::LiveMetrics(int stations)
+    : tick(0), firstTick(0), startTime(Now()), unloads(0), stationUnloads(new atomic<uint64_t>[stations]), stations(stations),
+      requested(true), snapshotTick(-1), queueDepth(new atomic<uint64_t>[stations])
+{
+    for (auto &count : minersByState)
+        count.store(0, memory_order_relaxed);
+    for (int station = 0; station < stations; station++)
+    {
+        stationUnloads[station].store(0, memory_order_relaxed);
+        queueDepth[station].store(0, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Marks the start of a run, the simulation rate is measured from here.
+ * @param tick First tick of the run, later than 0 for a restored run.
+ */
+void LiveMetrics::Begin(int tick)
+{
+    firstTick.store(tick, memory_order_relaxed);
+    this->tick.store(tick, memory_order_relaxed);
+    startTime.store(Now(), memory_order_relaxed);
+}
+
+/**
+ * @brief Updates the number of ticks simulated so far.
+ * @param tick Ticks simulated.
+ */
+void LiveMetrics::SetTick(int tick)
+{
+    this->tick.store(tick, memory_order_relaxed);
+}
+
+/**
+ * @brief Counts an unload at a station. Safe to call from any thread.
+ * @param station Index of the station.
+ */
+void LiveMetrics::RecordUnload(int station)
+{
+    unloads.fetch_add(1, memory_order_relaxed);
+    if (station >= 0 && station < stations)
+        stationUnloads[station].fetch_add(1, memory_order_relaxed);
+}
+
+/**
+ * @brief Checks whether a scrape is waiting for a fresh snapshot of the fleet.
+ * @return true If Publish should be called at the next opportunity.
+ */
+bool LiveMetrics::SnapshotRequested() const
+{
+    return requested.load(memory_order_relaxed);
+}
+
+/**
+ * @brief Publishes miners per state and queue depth per station. Only call between ticks.
+ * @param states State column of the fleet, indexed by miner ID.
+ * @param miners Number of miners.
+ * @param stationManager The run's stations.
+ */
+void LiveMetrics::Publish(const int *states, int miners, StationManager &stationManager)
+{
+    int counts[MINER_STATE_COUNT] = {};
+    for (int id = 0; id < miners; id++)
+    {
+        if (states[id] >= 0 && states[id] < MINER_STATE_COUNT)
+            counts[states[id]]++;
+    }
+    for (int state = 0; state < MINER_STATE_COUNT; state++)
+        minersByState[state].store(counts[state], memory_order_relaxed);
+    for (int station = 0; station < stations && station < stationManager.GetAssets(); station++)
+        queueDepth[station].store(stationManager.GetStation(station)->size(), memory_order_relaxed);
+    snapshotTick.store(tick.load(memory_order_relaxed), memory_order_relaxed);
+    requested.store(false, memory_order_relaxed);
+}
+
+/**
+ * @brief Renders the counters in the Prometheus text exposition format and asks for a fresh fleet snapshot.
+ * @return string The exposition.
+ */
+string LiveMetrics::Render()
+{
+    int current = tick.load(memory_order_relaxed);
+    double elapsed = (Now() - startTime.load(memory_order_relaxed)) / 1e9;
+    double rate = elapsed > 0 ? (current - firstTick.load(memory_order_relaxed)) / elapsed : 0.0;
+
+    ostringstream out;
+    out << "# HELP mining_sim_tick Ticks simulated so far.\n"
+        << "# TYPE mining_sim_tick gauge\n"
+        << "mining_sim_tick " << current << "\n"
+        << "# HELP mining_sim_ticks_per_second Simulated ticks per wall-clock second since the run started.\n"
+        << "# TYPE mining_sim_ticks_per_second gauge\n"
+        << "mining_sim_ticks_per_second " << rate << "\n"
+        << "# HELP mining_sim_unloads_total Unloads completed at all stations.\n"
+        << "# TYPE mining_sim_unloads_total counter\n"
+        << "mining_sim_unloads_total " << unloads.load(memory_order_relaxed) << "\n"
+        << "# HELP mining_sim_snapshot_tick Tick the miner and queue gauges were taken at, they are refreshed after every scrape.\n"
+        << "# TYPE mining_sim_snapshot_tick gauge\n"
+        << "mining_sim_snapshot_tick " << snapshotTick.load(memory_order_relaxed) << "\n"
+        << "# HELP mining_sim_miners Miners per state.\n"
+        << "# TYPE mining_sim_miners gauge\n";
+    for (int state = 0; state < MINER_STATE_COUNT; state++)
+        out << "mining_sim_miners{state=\"" << STATE_NAMES[state] << "\"} " << minersByState[state].load(memory_order_relaxed) << "\n";
+    out << "# HELP mining_sim_station_queue_depth Miners queued at a station.\n"
+        << "# TYPE mining_sim_station_queue_depth gauge\n";
+    for (int station = 0; station < stations; station++)
+        out << "mining_sim_station_queue_depth{station=\"" << station + 1 << "\"} " << queueDepth[station].load(memory_order_relaxed) << "\n";
+    out << "# HELP mining_sim_station_unloads_total Unloads completed at a station.\n"
+        << "# TYPE mining_sim_station_unloads_total counter\n";
+    for (int station = 0; station < stations; station++)
+        out << "mining_sim_station_unloads_total{station=\"" << station + 1 << "\"} " << stationUnloads[station].load(memory_order_relaxed) << "\n";
+
+    requested.store(true, memory_order_relaxed);
+    return out.str();
+}
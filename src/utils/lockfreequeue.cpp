@@ -0,0 +1,275 @@
+/**
+ * @file lockfreequeue.cpp
+ * @brief Implementation of LockFreeQueue, a Michael-Scott queue of IDs, and its shared QueueNodePool.
+ *
+ * Queues draw their nodes from a preallocated pool shared by every queue, so memory stays
+ * proportional to the number of IDs that can be queued at once rather than to queues times
+ * capacity. Node links and list heads are packed (index, tag) words whose tag is bumped on
+ * every update, which rules out ABA when a node is recycled between a read and a CAS.
+ */
+
+#include "../inlcude/utils/lockfreequeue.h"
+
+using namespace std;
+
+namespace
+{
+    uint64_t pack(uint32_t index, uint32_t tag)
+    {
+        return (static_cast<uint64_t>(tag) << 32) | index;
+    }
+
+    uint32_t indexOf(uint64_t ref)
+    {
+        return static_cast<uint32_t>(ref);
+    }
+
+    uint32_t tagOf(uint64_t ref)
+    {
+        return static_cast<uint32_t>(ref >> 32);
+    }
+}
+
+/**
+ * @brief Constructs a pool of nodes, all of them initially free.
+ * @param capacity Number of nodes. Every queue holds one node more than its length.
+ */
+QueueNodePool::QueueNodePool(size_t capacity) : nodes(new Node[capacity]), capacity(capacity), freeHead(pack(QUEUE_NIL, 0))
+{
+    if (capacity >= QUEUE_NIL)
+    {
+        throw std::length_error("Queue node pool too large");
+    }
+    for (size_t i = 0; i < capacity; i++)
+    {
+        nodes[i].value = -1;
+        nodes[i].next = pack(i + 1 < capacity ? static_cast<uint32_t>(i + 1) : QUEUE_NIL, 0);
+    }
+    if (capacity > 0)
+    {
+        freeHead = pack(0, 0);
+    }
+}
+
+/**
+ * @brief Takes a node off the free list.
+ * @return uint32_t Index of the node.
+ * @throws std::length_error if every node is in use.
+ */
+uint32_t QueueNodePool::acquire()
+{
+    uint64_t top = freeHead.load();
+    while (true)
+    {
+        uint32_t index = indexOf(top);
+        if (index == QUEUE_NIL)
+        {
+            throw std::length_error("Queue node pool exhausted");
+        }
+        // A stale read of next is harmless, the tagged CAS below fails if the node was taken meanwhile
+        uint32_t next = indexOf(nodes[index].next.load());
+        if (freeHead.compare_exchange_weak(top, pack(next, tagOf(top) + 1)))
+        {
+            return index;
+        }
+    }
+}
+
+/**
+ * @brief Returns a node to the free list.
+ * @param index Index of the node.
+ */
+void QueueNodePool::release(uint32_t index)
+{
+    Node &node = nodes[index];
+    uint64_t top = freeHead.load();
+    while (true)
+    {
+        node.next = pack(indexOf(top), tagOf(node.next.load()) + 1);
+        if (freeHead.compare_exchange_weak(top, pack(index, tagOf(top) + 1)))
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Accesses a node by index.
+ * @param index Index of the node.
+ * @return Node& The node.
+ */
+QueueNodePool::Node &QueueNodePool::operator[](uint32_t index)
+{
+    return nodes[index];
+}
+
+/**
+ * @brief Returns the number of nodes in the pool.
+ * @return size_t Pool capacity.
+ */
+size_t QueueNodePool::GetCapacity() const
+{
+    return capacity;
+}
+
+/**
+ * @brief Constructs an empty queue whose nodes come from the given pool.
+ * @param pool Pool shared with other queues.
+ */
+LockFreeQueue::LockFreeQueue(shared_ptr<QueueNodePool> pool) : pool(pool), count(0)
+{
+    // The queue always holds a dummy node ahead of its first element
+    uint32_t dummy = this->pool->acquire();
+    QueueNodePool::Node &node = (*this->pool)[dummy];
+    node.next = pack(QUEUE_NIL, tagOf(node.next.load()) + 1);
+    head = pack(dummy, 0);
+    tail = pack(dummy, 0);
+}
+
+/**
+ * @brief Returns every node still held by the queue to the pool.
+ */
+LockFreeQueue::~LockFreeQueue()
+{
+    int value;
+    while (pop(value))
+    {
+    }
+    pool->release(indexOf(head.load()));
+}
+
+/**
+ * @brief Appends a value to the back of the queue.
+ * @param value Value to add.
+ * @throws std::length_error if the shared pool has no free node.
+ */
+void LockFreeQueue::push(int value)
+{
+    uint32_t index = pool->acquire();
+    QueueNodePool::Node &node = (*pool)[index];
+    node.value = value;
+    node.next = pack(QUEUE_NIL, tagOf(node.next.load()) + 1);
+
+    uint64_t last;
+    while (true)
+    {
+        last = tail.load();
+        uint64_t next = (*pool)[indexOf(last)].next.load();
+        if (last != tail.load())
+            continue;
+
+        if (indexOf(next) == QUEUE_NIL)
+        {
+            if ((*pool)[indexOf(last)].next.compare_exchange_weak(next, pack(index, tagOf(next) + 1)))
+                break;
+        }
+        else
+        {
+            // Tail is lagging behind, help swing it forward
+            tail.compare_exchange_weak(last, pack(indexOf(next), tagOf(last) + 1));
+        }
+    }
+    tail.compare_exchange_strong(last, pack(index, tagOf(last) + 1));
+    count.fetch_add(1);
+}
+
+/**
+ * @brief Removes the value at the front of the queue.
+ * @param value Receives the removed value.
+ * @return true If a value was removed, false If the queue was empty.
+ */
+bool LockFreeQueue::pop(int &value)
+{
+    uint64_t first;
+    while (true)
+    {
+        first = head.load();
+        uint64_t last = tail.load();
+        uint64_t next = (*pool)[indexOf(first)].next.load();
+        if (first != head.load())
+            continue;
+
+        if (indexOf(first) == indexOf(last))
+        {
+            if (indexOf(next) == QUEUE_NIL)
+                return false;
+            tail.compare_exchange_weak(last, pack(indexOf(next), tagOf(last) + 1));
+        }
+        else
+        {
+            // Read before the CAS, once head moves the node may be recycled
+            value = (*pool)[indexOf(next)].value.load();
+            if (head.compare_exchange_weak(first, pack(indexOf(next), tagOf(first) + 1)))
+                break;
+        }
+    }
+    count.fetch_sub(1);
+    // The old dummy is retired, the popped node becomes the new dummy
+    pool->release(indexOf(first));
+    return true;
+}
+
+/**
+ * @brief Reads the value at the front of the queue without removing it.
+ *
+ * Wait-free: the read is retried at most PEEK_ATTEMPTS times while concurrent removals keep
+ * changing the front, after which the peek reports no stable front.
+ *
+ * @param value Receives the front value.
+ * @return true If a front value was observed, false If the queue was empty or kept changing.
+ */
+bool LockFreeQueue::peek(int &value) const
+{
+    for (int attempt = 0; attempt < PEEK_ATTEMPTS; attempt++)
+    {
+        uint64_t first = head.load();
+        uint64_t next = (*pool)[indexOf(first)].next.load();
+        if (indexOf(next) == QUEUE_NIL)
+        {
+            if (first == head.load())
+                return false;
+            continue;
+        }
+        int front = (*pool)[indexOf(next)].value.load();
+        // An unchanged tagged head means nothing was removed, so the node read is still the front
+        if (first == head.load())
+        {
+            value = front;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Copies the queued values, front to back. Only consistent while no thread modifies the queue.
+ * @param values Receives the values.
+ */
+void LockFreeQueue::contents(vector<int> &values) const
+{
+    values.clear();
+    uint64_t next = (*pool)[indexOf(head.load())].next.load();
+    while (indexOf(next) != QUEUE_NIL)
+    {
+        values.push_back((*pool)[indexOf(next)].value.load());
+        next = (*pool)[indexOf(next)].next.load();
+    }
+}
+
+/**
+ * @brief Returns the number of values in the queue.
+ * @return size_t Queue length.
+ */
+size_t LockFreeQueue::size() const
+{
+    return count.load();
+}
+
+/**
+ * @brief Checks whether the queue holds no values.
+ * @return true If the queue is empty.
+ */
+bool LockFreeQueue::empty() const
+{
+    return count.load() == 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file mappedfile.cpp
+ * @brief Implementation of MappedFile, a read-only memory mapping of a file.
+ */
+
+#include "../inlcude/utils/mappedfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/**
+ * @brief Maps a file into memory for reading.
+ * @param path Path of the file.
+ * @throws std::runtime_error if the file cannot be opened or mapped.
+ */
+MappedFile::MappedFile(const string &path) : data(nullptr), size(0)
+{
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    mappingHandle = nullptr;
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        throw runtime_error("Unable to open file: " + path);
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(fileHandle, &fileSize);
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if (size == 0)
+        return;
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle != nullptr)
+        data = static_cast<const char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr)
+    {
+        if (mappingHandle != nullptr)
+            CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        throw runtime_error("Unable to map file: " + path);
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw runtime_error("Unable to open file: " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        throw runtime_error("Unable to stat file: " + path);
+    }
+    size = static_cast<size_t>(info.st_size);
+    if (size > 0)
+    {
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(fd);
+            throw runtime_error("Unable to map file: " + path);
+        }
+        data = static_cast<const char *>(mapping);
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+#endif
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (data != nullptr)
+        UnmapViewOfFile(data);
+    if (mappingHandle != nullptr)
+        CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+#else
+    if (data != nullptr)
+        munmap(const_cast<char *>(data), size);
+#endif
+}
+
+/**
+ * @brief Returns the start of the mapped bytes.
+ * @return const char* Mapped data, nullptr for an empty file.
+ */
+const char *MappedFile::GetData() const
+{
+    return data;
+}
+
+/**
+ * @brief Returns the size of the mapped file.
+ * @return size_t Size in bytes.
+ */
+size_t MappedFile::GetSize() const
+{
+    return size;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file metricsflusher.cpp
+ * @brief Implementation of MetricsFlusher, which writes samples out in the background during a run.
+ *
+ * The flusher puts the MetricsHandler into streaming and draining mode. The handler keeps
+ * running aggregates for the summary and holds merged records until they are drained, instead of
+ * keeping every sample. Every interval the timer thread drains those records into the front
+ * buffer and hands it to the writer thread, which swaps it with the back buffer it has just
+ * written. The timer thread only waits if the writer has not finished the previous buffer.
+ * Each buffer is appended as whole lines and flushed, so a killed run leaves a readable file.
+ */
+
+#include "../inlcude/utils/metricsflusher.h"
+
+using namespace std;
+
+/**
+ * @brief Creates the output file and starts the writer thread.
+ * @param path Path of the file, replaced if it exists.
+ * @param format One of FORMAT.
+ * @param interval Ticks between flushes when driven by TickHandler.
+ * @param metricsHandler Handler whose samples are written, switched to streaming and draining mode.
+ * @throws std::runtime_error if the file cannot be created.
+ */
+MetricsFlusher::MetricsFlusher(const string &path, int format, int interval, MetricsHandler &metricsHandler)
+    : metricsHandler(metricsHandler), out(path), path(path), format(format), interval(max(1, interval)), pending(false), writing(false), closing(false), failed(false), written(0)
+{
+    if (!out.IsOpen())
+        throw runtime_error("Unable to open file: " + path);
+    if (format == CSV)
+        out.Raw("Asset,Metric,Tick,Value\n");
+    metricsHandler.SetStreaming(true);
+    metricsHandler.SetDraining(true);
+    writer = thread(&MetricsFlusher::run, this);
+}
+
+/**
+ * @brief Destructor, writes out what is left and stops the writer thread.
+ */
+MetricsFlusher::~MetricsFlusher()
+{
+    try
+    {
+        Close();
+    }
+    catch (const exception &)
+    {
+    }
+}
+
+/**
+ * @brief Hands the samples merged since the last flush to the writer thread.
+ * Waits only while the writer is still busy with the previous buffer. Called between ticks.
+ */
+void MetricsFlusher::Flush()
+{
+    unique_lock<mutex> lock(mtx);
+    cv.wait(lock, [this]
+            { return !pending; });
+    // The writer does not touch the front buffer until it is marked pending
+    lock.unlock();
+    metricsHandler.Drain(front);
+    lock.lock();
+    if (front.empty())
+        return;
+    pending = true;
+    cv.notify_all();
+}
+
+/**
+ * @brief Flushes and waits until every sample merged so far is in the file, so a checkpoint taken next does not lose any.
+ */
+void MetricsFlusher::Sync()
+{
+    Flush();
+    unique_lock<mutex> lock(mtx);
+    cv.wait(lock, [this]
+            { return !pending && !writing; });
+}
+
+/**
+ * @brief Flushes the remaining samples, waits for them to be written and stops the writer thread.
+ * The handler stops draining, its streaming aggregates still cover the whole run.
+ * @throws std::runtime_error if any write failed.
+ */
+void MetricsFlusher::Close()
+{
+    if (!writer.joinable())
+        return;
+    Flush();
+    {
+        lock_guard<mutex> lock(mtx);
+        closing = true;
+    }
+    cv.notify_all();
+    writer.join();
+    metricsHandler.SetDraining(false);
+    if (!out.Flush() || failed)
+        throw runtime_error("Unable to write file: " + path);
+}
+
+/**
+ * @brief Returns the number of ticks between flushes.
+ * @return int Flush interval.
+ */
+int MetricsFlusher::GetInterval() const
+{
+    return interval;
+}
+
+/**
+ * @brief Returns the number of samples written so far.
+ * @return uint64_t Sample count.
+ */
+uint64_t MetricsFlusher::GetWritten() const
+{
+    return written;
+}
+
+/**
+ * @brief Writer thread, swaps each pending front buffer with the back buffer and writes it out until closed.
+ */
+void MetricsFlusher::run()
+{
+    unique_lock<mutex> lock(mtx);
+    while (true)
+    {
+        cv.wait(lock, [this]
+                { return pending || closing; });
+        if (!pending)
+            break;
+        back.swap(front);
+        pending = false;
+        writing = true;
+        cv.notify_all();
+
+        lock.unlock();
+        write(back);
+        lock.lock();
+        writing = false;
+        cv.notify_all();
+    }
+}
+
+/**
+ * @brief Appends samples to the file as whole lines and flushes them.
+ * @param samples The samples, in the order they were drained.
+ */
+void MetricsFlusher::write(const vector<MetricsHandler::Record> &samples)
+{
+    for (const auto &sample : samples)
+    {
+        if (format == CSV)
+        {
+            out.Raw(name(assetNames, sample.asset, true));
+            out.Raw(",");
+            out.Raw(name(metricNames, sample.metric, false));
+            out.Raw(",");
+            out.Integer(sample.tick);
+            out.Raw(",");
+            out.Number(sample.value);
+            out.Raw("\n");
+        }
+        else
+        {
+            out.Raw("{\"asset\":");
+            out.String(name(assetNames, sample.asset, true));
+            out.Raw(",\"metric\":");
+            out.String(name(metricNames, sample.metric, false));
+            out.Raw(",\"tick\":");
+            out.Integer(sample.tick);
+            out.Raw(",\"value\":");
+            out.Number(sample.value);
+            out.Raw("}\n");
+        }
+    }
+    if (!out.Flush())
+        failed = true;
+    written += samples.size();
+}
+
+/**
+ * @brief Resolves an asset or metric ID to its name, asking the handler's registry once per ID.
+ * @param names Cache of names by ID.
+ * @param id The asset or metric ID.
+ * @param asset True for an asset ID, false for a metric ID.
+ * @return const string& The name.
+ */
+const string &MetricsFlusher::name(vector<string> &names, int id, bool asset)
+{
+    if (names.size() <= static_cast<size_t>(id))
+        names.resize(id + 1);
+    if (names[id].empty())
+        names[id] = asset ? metricsHandler.GetAssetName(id) : metricsHandler.GetMetricName(id);
+    return names[id];
+}
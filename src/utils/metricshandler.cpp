@@ -1,14 +1,41 @@
 /**
  * @file metricshandler.h
  * @brief Defines the MetricsHandler class for managing and recording metrics.
+ *
+ * Every recording thread appends to its own shard, so recording is safe under full parallelism
+ * without a global lock. Shards are folded into the merged store before metrics are read,
+ * listed or saved. Each merged batch is ordered by the tick samples were recorded at, which
+ * makes the result independent of which thread recorded what.
+ *
+ * In streaming mode shards hold running aggregates (count, sum, min, max, variance and a
+ * quantile sketch) per series instead of raw samples, so memory stays bounded by the number of
+ * series rather than growing with the length of the run.
+ *
+ * Rollups fold every merged sample into fixed-width tick buckets, for example hourly and daily.
+ * Combined with a raw window, which drops merged samples older than the latest ticks, a long run
+ * still yields time-resolved output at a memory cost set by its horizon and the bucket widths.
+ * While draining, merged records are handed to a writer instead, see MetricsFlusher.
  */
 #include "../inlcude/utils/MetricsHandler.h"
 
 using namespace std;
 
+namespace
+{
+    // Distinguishes handler instances in the per-thread shard cache, addresses could be reused
+    atomic<unsigned long long> nextSerial{0};
+}
+
+/**
+ * @brief Constructs an empty metrics handler. Handlers share nothing, a run can record into its own.
+ */
+MetricsHandler::MetricsHandler() : serial(nextSerial++), streaming(false), rolling(false), draining(false), rawWindow(-1), outputFormat(JSON), outputEncoding(ColumnarFile::F64)
+{
+}
+
 /**
- * @brief Retrieves the singleton instance of MetricsHandler.
- * @return MetricsHandler& Reference to the singleton instance.
+ * @brief Retrieves the process-wide MetricsHandler, the default target of a run's metrics.
+ * @return MetricsHandler& Reference to the shared instance.
  */
 MetricsHandler &MetricsHandler::GetInstance()
 {
@@ -17,14 +44,522 @@ MetricsHandler &MetricsHandler::GetInstance()
 }
 
 /**
- * @brief Records a metric under a specified category and metric name.
+ * @brief Records a metric under a specified category and metric name. Safe to call from any thread.
+ * The names are resolved through the registry, hot paths should register once and record by ID.
  * @param category The category under which to record the metric.
  * @param metricName The name of the metric to record.
  * @param value The value of the metric.
+ * @param tick The simulation tick the value belongs to, or -1 if it is not tied to a tick.
+ */
+void MetricsHandler::RecordMetric(const string &category, const string &metricName, double value, int tick)
+{
+    RecordMetric(RegisterAsset(category), RegisterMetric(metricName), value, tick);
+}
+
+/**
+ * @brief Records a metric for registered asset and metric IDs. Safe to call from any thread.
+ * No strings are built or compared, the record is appended to the calling thread's shard.
+ * @param asset ID returned by RegisterAsset.
+ * @param metric ID returned by RegisterMetric.
+ * @param value The value of the metric.
+ * @param tick The simulation tick the value belongs to, or -1 if it is not tied to a tick.
+ */
+void MetricsHandler::RecordMetric(int asset, int metric, double value, int tick)
+{
+    Shard &shard = LocalShard();
+    // Only contended while the shard is being merged
+    lock_guard<mutex> lock(shard.mtx);
+    if (streaming.load(memory_order_relaxed))
+    {
+        shard.aggregates[SeriesKey(asset, metric)].Add(value);
+        // Rollups and draining still need the record, it is only folded into its buckets or handed over when merged
+        if (!rolling.load(memory_order_relaxed) && !draining.load(memory_order_relaxed))
+            return;
+    }
+    shard.records.push_back({asset, metric, tick, value});
+}
+
+/**
+ * @brief Switches between keeping every sample and keeping running aggregates only.
+ * Meant to be set before recording starts, samples already recorded stay where they are.
+ * @param enabled True to aggregate samples as they are recorded.
+ */
+void MetricsHandler::SetStreaming(bool enabled)
+{
+    streaming = enabled;
+}
+
+/**
+ * @brief Checks whether samples are aggregated as they are recorded.
+ * @return true If streaming mode is on.
+ */
+bool MetricsHandler::IsStreaming() const
+{
+    return streaming;
+}
+
+/**
+ * @brief Sets the rollup widths and the raw window. Meant to be set before recording starts, existing rollups are dropped.
+ * @param widths Bucket widths in ticks, for example ROLLUP_HOUR_TICKS and ROLLUP_DAY_TICKS. Empty turns rollups off.
+ * @param rawWindow Ticks of raw samples kept behind the latest merged tick, -1 keeps every sample.
+ * @throws std::invalid_argument if a width is not positive or the window is below -1.
+ */
+void MetricsHandler::SetRollups(const vector<int> &widths, int rawWindow)
+{
+    if (rawWindow < -1)
+        throw invalid_argument("The raw window must be -1 or at least 0 ticks");
+    lock_guard<mutex> lock(shardsMtx);
+    rollups.SetWidths(widths);
+    this->rawWindow = rawWindow;
+    rolling = rollups.IsEnabled();
+}
+
+/**
+ * @brief Returns the rollup widths.
+ * @return vector<int> Widths in ticks, empty if rollups are off.
+ */
+vector<int> MetricsHandler::GetRollupWidths() const
+{
+    lock_guard<mutex> lock(shardsMtx);
+    return rollups.GetWidths();
+}
+
+/**
+ * @brief Returns the raw window.
+ * @return int Ticks of raw samples kept, -1 if every sample is kept.
+ */
+int MetricsHandler::GetRawWindow() const
+{
+    lock_guard<mutex> lock(shardsMtx);
+    return rawWindow;
+}
+
+/**
+ * @brief Retrieves the rollup of a series at one width.
+ * @param category The asset name, for example "Station-1".
+ * @param metricName The metric name.
+ * @param width Bucket width in ticks, one of the widths set with SetRollups.
+ * @return vector<RollupBucket> Buckets ordered by start tick, empty for unknown names and widths.
+ */
+vector<RollupBucket> MetricsHandler::GetRollup(const string &category, const string &metricName, int width) const
+{
+    Merge();
+    int asset, metric;
+    {
+        lock_guard<mutex> lock(registryMtx);
+        auto assetIt = assetIds.find(category);
+        auto metricIt = metricIds.find(metricName);
+        if (assetIt == assetIds.end() || metricIt == metricIds.end())
+            return {};
+        asset = assetIt->second;
+        metric = metricIt->second;
+    }
+    lock_guard<mutex> lock(shardsMtx);
+    const auto &widths = rollups.GetWidths();
+    auto level = find(widths.begin(), widths.end(), width);
+    if (level == widths.end())
+        return {};
+    return rollups.GetBuckets(asset, metric, static_cast<size_t>(level - widths.begin()));
+}
+
+/**
+ * @brief Switches between keeping merged records and holding them for Drain.
+ * Meant to be set before recording starts, together with streaming mode so the summary still covers every sample.
+ * @param enabled True to hold merged records for Drain.
  */
-void MetricsHandler::RecordMetric(const string &category, const string &metricName, double value)
+void MetricsHandler::SetDraining(bool enabled)
 {
-    metrics[category][metricName].push_back(value);
+    draining = enabled;
+}
+
+/**
+ * @brief Merges the shards and moves out every record merged while draining, ordered by series and tick within each merge.
+ * Safe to call while threads record.
+ * @param samples Receives the records, its old contents are dropped and its capacity reused for the next records.
+ */
+void MetricsHandler::Drain(vector<Record> &samples)
+{
+    Merge();
+    lock_guard<mutex> lock(shardsMtx);
+    samples.clear();
+    samples.swap(drained);
+}
+
+/**
+ * @brief Folds the shards into the rollups and applies the raw window, so memory stays bounded during a long run.
+ * A no-op without rollups or a raw window. Called between ticks by TickHandler.
+ */
+void MetricsHandler::Compact()
+{
+    if (rolling || GetRawWindow() >= 0)
+        Merge();
+}
+
+/**
+ * @brief Writes the name registry, every merged sample or aggregate and the rollups to a checkpoint.
+ * Records waiting to be drained are not written, TickHandler flushes its MetricsFlusher before checkpointing.
+ * @param out The checkpoint being written.
+ */
+void MetricsHandler::SaveCheckpoint(CheckpointWriter &out) const
+{
+    Merge();
+    lock_guard<mutex> lock(registryMtx);
+    out.Write<uint8_t>(streaming ? 1 : 0);
+    out.Write<uint64_t>(assetNames.size());
+    for (const auto &name : assetNames)
+        out.WriteString(name);
+    out.Write<uint64_t>(metricNames.size());
+    for (const auto &name : metricNames)
+        out.WriteString(name);
+
+    for (size_t asset = 0; asset < assetNames.size(); asset++)
+    {
+        const auto &assetMetrics = metrics[asset];
+        out.Write<uint64_t>(assetMetrics.size());
+        for (size_t metric = 0; metric < assetMetrics.size(); metric++)
+        {
+            out.WriteArray(assetMetrics[metric]);
+            out.WriteArray(ticks[asset][metric]);
+        }
+
+        const auto &assetAggregates = aggregates[asset];
+        out.Write<uint64_t>(assetAggregates.size());
+        for (const auto &stats : assetAggregates)
+            stats.SaveCheckpoint(out);
+    }
+    out.Write<int32_t>(rawWindow);
+    rollups.SaveCheckpoint(out);
+}
+
+/**
+ * @brief Replaces the name registry and every recorded metric with those read from a checkpoint.
+ * Meant to be called while nothing is recording. IDs are restored as they were saved.
+ * @param in The checkpoint being read.
+ */
+void MetricsHandler::RestoreCheckpoint(CheckpointReader &in)
+{
+    lock_guard<mutex> lock(shardsMtx);
+    lock_guard<mutex> registryLock(registryMtx);
+    for (const auto &shard : shards)
+    {
+        lock_guard<mutex> shardLock(shard->mtx);
+        shard->records.clear();
+        shard->aggregates.clear();
+    }
+    drained.clear();
+
+    streaming = in.Read<uint8_t>() != 0;
+    assetNames.resize(static_cast<size_t>(in.Read<uint64_t>()));
+    assetIds.clear();
+    for (size_t asset = 0; asset < assetNames.size(); asset++)
+    {
+        assetNames[asset] = in.ReadString();
+        assetIds[assetNames[asset]] = static_cast<int>(asset);
+    }
+    metricNames.resize(static_cast<size_t>(in.Read<uint64_t>()));
+    metricIds.clear();
+    for (size_t metric = 0; metric < metricNames.size(); metric++)
+    {
+        metricNames[metric] = in.ReadString();
+        metricIds[metricNames[metric]] = static_cast<int>(metric);
+    }
+
+    metrics.assign(assetNames.size(), {});
+    ticks.assign(assetNames.size(), {});
+    aggregates.assign(assetNames.size(), {});
+    for (size_t asset = 0; asset < assetNames.size(); asset++)
+    {
+        metrics[asset].resize(static_cast<size_t>(in.Read<uint64_t>()));
+        ticks[asset].resize(metrics[asset].size());
+        for (size_t metric = 0; metric < metrics[asset].size(); metric++)
+        {
+            in.ReadArray(metrics[asset][metric]);
+            in.ReadArray(ticks[asset][metric]);
+            if (ticks[asset][metric].size() != metrics[asset][metric].size())
+                throw runtime_error("Corrupt checkpoint");
+        }
+
+        aggregates[asset].resize(static_cast<size_t>(in.Read<uint64_t>()));
+        for (auto &stats : aggregates[asset])
+            stats.RestoreCheckpoint(in);
+    }
+    rawWindow = in.Read<int32_t>();
+    rollups.RestoreCheckpoint(in);
+    rolling = rollups.IsEnabled();
+}
+
+/**
+ * @brief Resolves an asset (category) name to its dense ID, registering it on first use.
+ * @param name The asset name, for example "Miner-1".
+ * @return int The asset ID.
+ */
+int MetricsHandler::RegisterAsset(const string &name)
+{
+    lock_guard<mutex> lock(registryMtx);
+    auto it = assetIds.find(name);
+    if (it != assetIds.end())
+    {
+        return it->second;
+    }
+    assetNames.push_back(name);
+    return assetIds[name] = static_cast<int>(assetNames.size()) - 1;
+}
+
+/**
+ * @brief Resolves a metric name to its dense ID, registering it on first use.
+ * @param name The metric name, for example "DistanceTraveled".
+ * @return int The metric ID.
+ */
+int MetricsHandler::RegisterMetric(const string &name)
+{
+    lock_guard<mutex> lock(registryMtx);
+    auto it = metricIds.find(name);
+    if (it != metricIds.end())
+    {
+        return it->second;
+    }
+    metricNames.push_back(name);
+    return metricIds[name] = static_cast<int>(metricNames.size()) - 1;
+}
+
+/**
+ * @brief Returns the name an asset ID was registered with.
+ * @param asset The asset ID.
+ * @return string The asset name.
+ */
+string MetricsHandler::GetAssetName(int asset) const
+{
+    lock_guard<mutex> lock(registryMtx);
+    return assetNames.at(asset);
+}
+
+/**
+ * @brief Returns the name a metric ID was registered with.
+ * @param metric The metric ID.
+ * @return string The metric name.
+ */
+string MetricsHandler::GetMetricName(int metric) const
+{
+    lock_guard<mutex> lock(registryMtx);
+    return metricNames.at(metric);
+}
+
+/**
+ * @brief Returns the calling thread's shard, registering a new one on the thread's first record.
+ * The thread only caches the shard of the handler it recorded into last, switching handlers costs one locked lookup.
+ * @return Shard& The calling thread's shard.
+ */
+MetricsHandler::Shard &MetricsHandler::LocalShard()
+{
+    thread_local pair<unsigned long long, Shard *> cache{0, nullptr};
+    if (cache.second && cache.first == serial)
+        return *cache.second;
+
+    lock_guard<mutex> lock(shardsMtx);
+    Shard *&shard = threadShards[this_thread::get_id()];
+    if (!shard)
+    {
+        shards.emplace_back(make_unique<Shard>());
+        shard = shards.back().get();
+    }
+    cache = {serial, shard};
+    return *shard;
+}
+
+/**
+ * @brief Packs an asset and metric ID into the key of a streaming aggregate.
+ * @param asset The asset ID.
+ * @param metric The metric ID.
+ * @return uint64_t The series key.
+ */
+uint64_t MetricsHandler::SeriesKey(int asset, int metric)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(asset)) << 32) | static_cast<uint32_t>(metric);
+}
+
+/**
+ * @brief Folds every shard into the merged table and empties the shards.
+ *
+ * Shards are visited in registration order and the batch is stably sorted by series and tick,
+ * so the merged order does not depend on how work was spread over threads. Streaming
+ * aggregates are merged shard by shard into the series they belong to. Records are folded
+ * into the rollups and, while draining, held for Drain. In streaming mode they are only kept for that.
+ * With a raw window the kept records are also added to the aggregates before the window trims them.
+ */
+void MetricsHandler::Merge() const
+{
+    lock_guard<mutex> lock(shardsMtx);
+    vector<Record> batch;
+    {
+        lock_guard<mutex> registryLock(registryMtx);
+        metrics.resize(assetNames.size());
+        ticks.resize(assetNames.size());
+        aggregates.resize(assetNames.size());
+    }
+    for (const auto &shard : shards)
+    {
+        lock_guard<mutex> shardLock(shard->mtx);
+        batch.insert(batch.end(), shard->records.begin(), shard->records.end());
+        shard->records.clear();
+        for (const auto &[key, stats] : shard->aggregates)
+        {
+            auto &assetAggregates = aggregates[key >> 32];
+            size_t metric = static_cast<uint32_t>(key);
+            if (assetAggregates.size() <= metric)
+                assetAggregates.resize(metric + 1);
+            assetAggregates[metric].Merge(stats);
+        }
+        shard->aggregates.clear();
+    }
+    if (batch.empty())
+        return;
+
+    stable_sort(batch.begin(), batch.end(), [](const Record &a, const Record &b)
+                { return tie(a.asset, a.metric, a.tick) < tie(b.asset, b.metric, b.tick); });
+
+    int latest = -1;
+    for (const auto &record : batch)
+    {
+        rollups.Add(record.asset, record.metric, record.tick, record.value);
+        latest = max(latest, record.tick);
+    }
+    if (draining)
+    {
+        if (drained.empty())
+            drained.swap(batch);
+        else
+            drained.insert(drained.end(), batch.begin(), batch.end());
+        return;
+    }
+    if (streaming)
+        return;
+
+    for (size_t first = 0; first < batch.size();)
+    {
+        int asset = batch[first].asset;
+        int metric = batch[first].metric;
+        auto &assetMetrics = metrics[asset];
+        if (static_cast<int>(assetMetrics.size()) <= metric)
+        {
+            assetMetrics.resize(metric + 1);
+            ticks[asset].resize(metric + 1);
+        }
+        auto &values = assetMetrics[metric];
+        auto &valueTicks = ticks[asset][metric];
+        // The raw window drops samples, the aggregates still cover every one for the summary
+        StreamingStats *stats = nullptr;
+        if (rawWindow >= 0)
+        {
+            if (static_cast<int>(aggregates[asset].size()) <= metric)
+                aggregates[asset].resize(metric + 1);
+            stats = &aggregates[asset][metric];
+        }
+
+        size_t merged = values.size();
+        size_t last = first;
+        for (; last < batch.size() && batch[last].asset == asset && batch[last].metric == metric; last++)
+        {
+            values.push_back(batch[last].value);
+            valueTicks.push_back(batch[last].tick);
+            if (stats)
+                stats->Add(batch[last].value);
+        }
+        // Columns stay ordered by tick for range queries, even if a batch reaches back before earlier ones
+        if (merged > 0 && valueTicks[merged - 1] > valueTicks[merged])
+            MergeByTick(values, valueTicks, merged);
+        first = last;
+    }
+    if (rawWindow >= 0)
+        TrimRaw(latest);
+}
+
+/**
+ * @brief Drops the merged samples recorded more than the raw window before the latest tick. Samples not tied to a tick are kept.
+ * @param latest The latest tick merged.
+ */
+void MetricsHandler::TrimRaw(int latest) const
+{
+    int cutoff = latest - rawWindow + 1;
+    if (cutoff <= 0)
+        return;
+    for (size_t asset = 0; asset < metrics.size(); asset++)
+    {
+        for (size_t metric = 0; metric < metrics[asset].size(); metric++)
+        {
+            auto &valueTicks = ticks[asset][metric];
+            auto first = lower_bound(valueTicks.begin(), valueTicks.end(), 0);
+            auto last = lower_bound(first, valueTicks.end(), cutoff);
+            if (first == last)
+                continue;
+            auto &values = metrics[asset][metric];
+            values.erase(values.begin() + (first - valueTicks.begin()), values.begin() + (last - valueTicks.begin()));
+            valueTicks.erase(first, last);
+        }
+    }
+}
+
+/**
+ * @brief Merges the two tick-ordered runs of a column into one, keeping samples of the same tick in recording order.
+ * @param values The column's samples.
+ * @param valueTicks The ticks of the samples.
+ * @param middle Start of the second run.
+ */
+void MetricsHandler::MergeByTick(vector<double> &values, vector<int> &valueTicks, size_t middle)
+{
+    vector<size_t> order(values.size());
+    iota(order.begin(), order.end(), 0);
+    inplace_merge(order.begin(), order.begin() + static_cast<ptrdiff_t>(middle), order.end(), [&valueTicks](size_t a, size_t b)
+                  { return valueTicks[a] < valueTicks[b]; });
+
+    vector<double> sortedValues(values.size());
+    vector<int> sortedTicks(values.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        sortedValues[i] = values[order[i]];
+        sortedTicks[i] = valueTicks[order[i]];
+    }
+    values.swap(sortedValues);
+    valueTicks.swap(sortedTicks);
+}
+
+/**
+ * @brief Orders registered IDs by name, the order metrics are listed and exported in.
+ * @param names Names indexed by ID.
+ * @return vector<int> IDs sorted by name.
+ */
+vector<int> MetricsHandler::SortedByName(const vector<string> &names) const
+{
+    vector<int> ids(names.size());
+    iota(ids.begin(), ids.end(), 0);
+    sort(ids.begin(), ids.end(), [&names](int a, int b)
+         { return names[a] < names[b]; });
+    return ids;
+}
+
+/**
+ * @brief Checks whether a series has any merged samples or aggregates.
+ * @param asset The asset ID.
+ * @param metric The metric ID.
+ * @return true If something was recorded for the series.
+ */
+bool MetricsHandler::HasSeries(int asset, int metric) const
+{
+    bool aggregated = asset < static_cast<int>(aggregates.size()) && metric < static_cast<int>(aggregates[asset].size()) && aggregates[asset][metric].GetCount() > 0;
+    if (streaming)
+        return aggregated;
+    // A raw window may have trimmed every sample of a series its aggregates still cover
+    return aggregated || HasSamples(asset, metric);
+}
+
+/**
+ * @brief Checks whether a series has any merged samples, whether or not the handler is streaming.
+ * @param asset The asset ID.
+ * @param metric The metric ID.
+ * @return true If the series holds samples.
+ */
+bool MetricsHandler::HasSamples(int asset, int metric) const
+{
+    return asset < static_cast<int>(metrics.size()) && metric < static_cast<int>(metrics[asset].size()) && !metrics[asset][metric].empty();
 }
 
 /**
@@ -34,93 +569,324 @@ void MetricsHandler::RecordMetric(const string &category, const string &metricNa
  */
 map<string, vector<double>> MetricsHandler::GetMetrics(const string &category) const
 {
-    auto it = metrics.find(category);
-    if (it != metrics.end())
+    Merge();
+    lock_guard<mutex> lock(registryMtx);
+    map<string, vector<double>> result;
+    auto it = assetIds.find(category);
+    if (it != assetIds.end() && it->second < static_cast<int>(metrics.size()))
     {
-        return it->second;
+        const auto &assetMetrics = metrics[it->second];
+        for (size_t metric = 0; metric < assetMetrics.size(); metric++)
+        {
+            if (!assetMetrics[metric].empty())
+                result[metricNames[metric]] = assetMetrics[metric];
+        }
     }
-    return {};
+    return result;
+}
+
+/**
+ * @brief Returns a read-only view of a series' samples and their ticks, without copying them.
+ * @param asset The asset ID.
+ * @param metric The metric ID.
+ * @return SeriesView The samples ordered by tick, empty if none were kept or the handler is streaming.
+ */
+MetricsHandler::SeriesView MetricsHandler::GetSeries(int asset, int metric) const
+{
+    Merge();
+    if (streaming || asset < 0 || metric < 0 || !HasSeries(asset, metric))
+        return SeriesView();
+    const auto &values = metrics[asset][metric];
+    return SeriesView(values.data(), ticks[asset][metric].data(), values.size());
+}
+
+/**
+ * @brief Returns a read-only view of a series' samples and their ticks, looked up by name without copying them.
+ * @param category The asset name, for example "Miner-1".
+ * @param metricName The metric name.
+ * @return SeriesView The samples ordered by tick, empty for unknown names.
+ */
+MetricsHandler::SeriesView MetricsHandler::GetSeries(const string &category, const string &metricName) const
+{
+    int asset, metric;
+    {
+        lock_guard<mutex> lock(registryMtx);
+        auto assetIt = assetIds.find(category);
+        auto metricIt = metricIds.find(metricName);
+        if (assetIt == assetIds.end() || metricIt == metricIds.end())
+            return SeriesView();
+        asset = assetIt->second;
+        metric = metricIt->second;
+    }
+    return GetSeries(asset, metric);
+}
+
+/**
+ * @brief Returns a read-only view of the samples of a series recorded in a window of ticks.
+ * @param category The asset name.
+ * @param metricName The metric name.
+ * @param fromTick First tick of the window.
+ * @param toTick One past the last tick of the window.
+ * @return SeriesView The samples recorded at ticks in [fromTick, toTick).
+ */
+MetricsHandler::SeriesView MetricsHandler::GetSeries(const string &category, const string &metricName, int fromTick, int toTick) const
+{
+    return GetSeries(category, metricName).Between(fromTick, toTick);
+}
+
+/**
+ * @brief Constructs a view of count samples and their ticks.
+ * @param values First sample.
+ * @param ticks Tick of the first sample.
+ * @param count Number of samples.
+ */
+MetricsHandler::SeriesView::SeriesView(const double *values, const int *ticks, size_t count) : values(values), ticks(ticks), count(count)
+{
+}
+
+/**
+ * @brief Narrows the view to the samples recorded in a window of ticks, found by binary search.
+ * @param fromTick First tick of the window.
+ * @param toTick One past the last tick of the window.
+ * @return SeriesView The samples recorded at ticks in [fromTick, toTick).
+ */
+MetricsHandler::SeriesView MetricsHandler::SeriesView::Between(int fromTick, int toTick) const
+{
+    if (count == 0 || fromTick >= toTick)
+        return SeriesView();
+    size_t first = static_cast<size_t>(lower_bound(ticks, ticks + count, fromTick) - ticks);
+    size_t last = static_cast<size_t>(lower_bound(ticks + first, ticks + count, toTick) - ticks);
+    return SeriesView(values + first, ticks + first, last - first);
+}
+
+/**
+ * @brief Retrieves the streaming aggregates for a specified category.
+ * Aggregates merge, so those of separate runs can be combined with StreamingStats::Merge.
+ * @param category The category for which to retrieve aggregates.
+ * @return map<string, StreamingStats> A map of metric names to their aggregates.
+ */
+map<string, StreamingStats> MetricsHandler::GetAggregates(const string &category) const
+{
+    Merge();
+    lock_guard<mutex> lock(registryMtx);
+    map<string, StreamingStats> result;
+    auto it = assetIds.find(category);
+    if (it != assetIds.end() && it->second < static_cast<int>(aggregates.size()))
+    {
+        const auto &assetAggregates = aggregates[it->second];
+        for (size_t metric = 0; metric < assetAggregates.size(); metric++)
+        {
+            if (assetAggregates[metric].GetCount() > 0)
+                result[metricNames[metric]] = assetAggregates[metric];
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Aggregates every asset's samples of each metric, e.g. DistanceTraveled over the whole fleet.
+ * Works in both modes, streamed aggregates are merged and raw samples are folded in.
+ * @return map<string, StreamingStats> A map of metric names to their fleet-wide aggregates.
+ */
+map<string, StreamingStats> MetricsHandler::GetAggregatesByMetric() const
+{
+    Merge();
+    lock_guard<mutex> lock(registryMtx);
+    map<string, StreamingStats> result;
+    for (size_t asset = 0; asset < metrics.size(); asset++)
+    {
+        for (size_t metric = 0; metric < metrics[asset].size(); metric++)
+        {
+            if (metrics[asset][metric].empty())
+                continue;
+            StreamingStats &stats = result[metricNames[metric]];
+            for (double value : metrics[asset][metric])
+                stats.Add(value);
+        }
+    }
+    for (size_t asset = 0; asset < aggregates.size(); asset++)
+    {
+        for (size_t metric = 0; metric < aggregates[asset].size(); metric++)
+        {
+            if (aggregates[asset][metric].GetCount() > 0)
+                result[metricNames[metric]].Merge(aggregates[asset][metric]);
+        }
+    }
+    return result;
 }
 
 /**
  * @brief Lists all metrics recorded, formatted for console output.
- * @note metrics is a std::map<std::string, std::map<std::string, std::vector<double>>>
+ * @note metrics is a flat [asset][metric] table of std::vector<double>, listed in name order
+ * @note Assets are summarized in parallel, each series in one StatsKernel pass plus percentiles by selection
+ * @note In streaming mode the same figures come from the aggregates, with sketched percentiles
+ * @note With a raw window they also come from the aggregates, so they cover the whole run and not only the window
  */
 void MetricsHandler::ListAllMetrics()
 {
-    //We create this tuple to store the averages/totals/max/min we calculate so we can add them to the map before parsing to json
-    vector<tuple<string, string, double>> finalMetrics;
-    //Entering the Category/First layer of this map of maps. It's the Miner or Station we're logging
-    for (const auto &categoryPair : metrics)
+    Merge();
+
+    vector<int> assetOrder = SortedByName(assetNames);
+    vector<int> metricOrder = SortedByName(metricNames);
+
+    // Each asset's console lines and summary figures, filled in on the pool and printed in name order
+    vector<string> listings(assetOrder.size());
+    vector<vector<pair<string, double>>> figures(assetOrder.size());
+    WorkerPool pool(0);
+    int assets = static_cast<int>(assetOrder.size());
+    int grain = max(1, assets / static_cast<int>(pool.GetWorkers() * 8));
+    pool.parallelFor(0, assets, grain, [&](int begin, int end, unsigned int)
+                     {
+                         vector<double> scratch;
+                         for (int i = begin; i < end; i++)
+                             SummarizeAsset(assetOrder[i], metricOrder, listings[i], figures[i], scratch); });
+
+    summaries.assign(assetNames.size(), {});
+    for (size_t i = 0; i < assetOrder.size(); i++)
+    {
+        cout << listings[i];
+        //Keeps the calculated metrics apart from the recorded series, they are exported next to them
+        sort(figures[i].begin(), figures[i].end());
+        summaries[assetOrder[i]] = move(figures[i]);
+    }
+    if (outputFormat == COLUMNAR)
+        SaveMetricsToColumnar("test.msc", outputEncoding);
+    else if (outputFormat == JSON_SHARDED)
+        SaveMetricsToJsonShards("test.json");
+    else
+        SaveMetricsToJson("test.json");
+    if (rolling)
+        SaveRollupsToCsv("rollups.csv");
+}
+
+/**
+ * @brief Summarizes the metrics of one asset for ListAllMetrics. Only reads the merged store, so assets can be summarized in parallel.
+ * @param asset The asset ID.
+ * @param metricOrder Metric IDs in name order.
+ * @param listing Receives the console lines, empty if the asset has no metrics.
+ * @param figures Receives the summary figures by name, exported next to the asset's series once listed.
+ * @param scratch Reused buffer that percentiles are selected in.
+ */
+void MetricsHandler::SummarizeAsset(int asset, const vector<int> &metricOrder, string &listing, vector<pair<string, double>> &figures, vector<double> &scratch) const
+{
+    static const double QUANTILES[] = {0.5, 0.9, 0.99};
+    static const char *const QUANTILE_NAMES[] = {"-P50", "-P90", "-P99"};
+    // The raw window only keeps the latest samples, the aggregates cover the whole run
+    bool streamed = streaming || rawWindow >= 0;
+    const string &category = assetNames[asset];
+
+    // Every recorded metric of the asset, paired with its name
+    vector<pair<const string *, int>> assetMetrics;
+    for (int metric : metricOrder)
+    {
+        if (HasSeries(asset, metric))
+            assetMetrics.emplace_back(&metricNames[metric], metric);
+    }
+    if (assetMetrics.empty())
+        return;
+
+    ostringstream out;
+    if (category.rfind("Miner", 0) == 0)
     {
-        if (categoryPair.first.rfind("Miner", 0) == 0)
+        out << "Category: " << category << endl;
+        // Entering the Data/Second Layer. These are the stats like DistanceTraveled and the list/array of values over the time of the simulation
+        for (const auto &[name, metric] : assetMetrics)
         {
-            cout << "Category: " << categoryPair.first << endl;
-            // Entering the Data/Second Layer. These are the stats like DistanceTraveled and the list/array of values over the time of the simulation
-            for (const auto &metricPair : categoryPair.second)
+            double total, average, maxValue, minValue;
+            double percentiles[3];
+            if (streamed)
             {
-                double total = accumulate(metricPair.second.begin(), metricPair.second.end(), 0.0);
-                double average = metricPair.second.empty() ? 0.0 : total / metricPair.second.size();
-                auto [minIt, maxIt] = minmax_element(metricPair.second.begin(), metricPair.second.end());
-                
-                cout << "  " << metricPair.first
-                            << " - Total: " << total
-                            << ", Average: " << average
-                            << ", Max: " << (maxIt != metricPair.second.end() ? *maxIt : 0.0)
-                            << ", Min: " << (minIt != metricPair.second.end() ? *minIt : 0.0)
-                            << endl;
-                finalMetrics.push_back(make_tuple(categoryPair.first, metricPair.first+"-Total", total));
-                finalMetrics.push_back(make_tuple(categoryPair.first, metricPair.first + "-Avg", average));
-                finalMetrics.push_back(make_tuple(categoryPair.first, metricPair.first + "-Max", *maxIt));
-                finalMetrics.push_back(make_tuple(categoryPair.first, metricPair.first + "-Min", *minIt));
+                const StreamingStats &stats = aggregates[asset][metric];
+                total = stats.GetSum();
+                average = stats.GetMean();
+                maxValue = stats.GetMax();
+                minValue = stats.GetMin();
+                for (int q = 0; q < 3; q++)
+                    percentiles[q] = stats.Quantile(QUANTILES[q]);
             }
+            else
+            {
+                const vector<double> &values = metrics[asset][metric];
+                SeriesSummary summary = StatsKernel::Summarize(values);
+                total = summary.sum;
+                average = total / values.size();
+                maxValue = summary.max;
+                minValue = summary.min;
+                scratch.assign(values.begin(), values.end());
+                StatsKernel::Percentiles(scratch, QUANTILES, percentiles, 3);
+            }
+
+            out << "  " << *name
+                << " - Total: " << total
+                << ", Average: " << average
+                << ", Max: " << maxValue
+                << ", Min: " << minValue;
+            figures.emplace_back(*name + "-Total", total);
+            figures.emplace_back(*name + "-Avg", average);
+            figures.emplace_back(*name + "-Max", maxValue);
+            figures.emplace_back(*name + "-Min", minValue);
+            out << ", P50: " << percentiles[0]
+                << ", P90: " << percentiles[1]
+                << ", P99: " << percentiles[2] << endl;
+            for (int q = 0; q < 3; q++)
+                figures.emplace_back(*name + QUANTILE_NAMES[q], percentiles[q]);
         }
-        //Same as Miner but we only need the Average of material quality and the total material volume
-        else if (categoryPair.first.rfind("Station", 0) == 0)
+    }
+    //Same as Miner but we only need the Average of material quality and the total material volume
+    else if (category.rfind("Station", 0) == 0)
+    {
+        out << "Category: " << category << endl;
+        for (const auto &[name, metric] : assetMetrics)
         {
-            cout << "Category: " << categoryPair.first << endl;
-            for (const auto &metricPair : categoryPair.second)
+            if (*name == "MaterialVolume" || *name == "UtilizationRate")
             {
-                auto category = categoryPair.first;
-                if (metricPair.first == "MaterialVolume" || metricPair.first == "UtilizationRate")
+                double total = streamed ? aggregates[asset][metric].GetSum() : StatsKernel::Summarize(metrics[asset][metric]).sum;
+                out << "  " << *name << " - Total: " << total << endl;
+                figures.emplace_back(*name + "Total", total);
+            }
+            else if (*name == "MaterialQuality")
+            {
+                double total = 0.0;
+                size_t count = 0;
+                if (streamed)
                 {
-                    double total = accumulate(metricPair.second.begin(), metricPair.second.end(), 0.0);
-                    cout << "  " << metricPair.first << " - Total: " << total << endl;
-                    finalMetrics.push_back(make_tuple(categoryPair.first, metricPair.first + "Total", total));
+                    // Aggregates cannot drop zero samples after the fact, qualities are always positive
+                    total = aggregates[asset][metric].GetSum();
+                    count = aggregates[asset][metric].GetCount();
                 }
-                else if (metricPair.first == "MaterialQuality")
+                else
                 {
-                    double total = 0.0;
-                    size_t count = 0;
-                    for (double value : metricPair.second)
-                    {
-                        if (value > 0)
-                        {
-                            total += value;
-                            ++count;
-                        }
-                    }
-                    double average = count > 0 ? total / count : 0.0;
-                    cout << "  " << metricPair.first << " - Average: " << average << endl;
-                    finalMetrics.push_back(make_tuple(categoryPair.first, metricPair.first + "Avg", average));
+                    SeriesSummary summary = StatsKernel::Summarize(metrics[asset][metric]);
+                    total = summary.positiveSum;
+                    count = summary.positiveCount;
                 }
+                double average = count > 0 ? total / count : 0.0;
+                out << "  " << *name << " - Average: " << average << endl;
+                figures.emplace_back(*name + "Avg", average);
             }
         }
-        cout << endl;
     }
+    out << endl;
+    listing = out.str();
+}
 
-    //Transfers the calculated metrics to the map
-    for(auto metric : finalMetrics)
-    {
-        double value = get<2>(metric);
-        RecordMetric(get<0>(metric), get<1>(metric), value);
-    }
-    SaveMetricsToJson("test.json");
+/**
+ * @brief Chooses the format ListAllMetrics saves the results in.
+ * @param format One of FORMAT.
+ * @param encoding Column encoding used by the columnar format, one of ColumnarFile::ENCODING.
+ */
+void MetricsHandler::SetOutputFormat(int format, int encoding)
+{
+    outputFormat = format;
+    outputEncoding = encoding;
 }
+
 /**
- * @brief Exports all the granular data to a json file
+ * @brief Inserts a timestamp before the extension of a filename, e.g. test.json becomes ./test_2024-01-01_12-00-00.json
+ * @param filename The filename.
+ * @return string The path to write to.
  */
-void MetricsHandler::SaveMetricsToJson(const string &filename) const
+string MetricsHandler::TimestampedPath(const string &filename)
 {
     // Getting timestamp for file name
     auto now = chrono::system_clock::now();
@@ -133,28 +899,282 @@ void MetricsHandler::SaveMetricsToJson(const string &filename) const
     string timestampedFilename = filename.substr(0, filename.find_last_of('.')) + "_" + ss.str() + filename.substr(filename.find_last_of('.'));
 
     // Construct the path relative to the executable location
-    string relativePath = "./" + timestampedFilename; // Adjusts path to point to src directory
-
-    //Parsing the metrics to a json file
-    nlohmann::json json;
-    for (const auto &cat : metrics)
+    return "./" + timestampedFilename; // Adjusts path to point to src directory
+}
+/**
+ * @brief Writes one asset's series and summary figures as a JSON object, in name order.
+ * Series with samples are written as arrays, streamed series as their aggregates and summary figures as one-element arrays.
+ * @param out The writer.
+ * @param asset The asset ID.
+ * @param metricOrder Metric IDs sorted by name.
+ * @param depth Nesting depth of the object.
+ * @param separator Written ahead of the object, only if the asset has any series.
+ * @return true If the asset had any series.
+ */
+bool MetricsHandler::WriteAssetJson(JsonWriter &out, int asset, const vector<int> &metricOrder, int depth, const char *separator) const
+{
+    static const vector<pair<string, double>> noFigures;
+    const auto &figures = asset < static_cast<int>(summaries.size()) ? summaries[asset] : noFigures;
+    size_t figure = 0;
+    bool first = true;
+    // Series and summary figures are both sorted by name and interleaved
+    for (size_t next = 0; next < metricOrder.size() || figure < figures.size();)
     {
-        for (const auto &met : cat.second)
+        bool summarized = next == metricOrder.size() || (figure < figures.size() && figures[figure].first < metricNames[metricOrder[next]]);
+        int metric = summarized ? -1 : metricOrder[next++];
+        // Windowed series keep exporting their latest samples, unless the window has trimmed them all
+        bool streamed = !summarized && asset < static_cast<int>(aggregates.size()) && metric < static_cast<int>(aggregates[asset].size()) &&
+                        aggregates[asset][metric].GetCount() > 0 && (streaming || !HasSamples(asset, metric));
+        if (!summarized && !streamed && !HasSamples(asset, metric))
+            continue;
+
+        if (first)
         {
-            json[cat.first][met.first] = met.second;
+            out.Raw(separator);
+            out.Indent(depth);
+            out.String(assetNames[asset]);
+            out.Raw(": {");
         }
+        else
+        {
+            out.Raw(",");
+        }
+        first = false;
+        out.Indent(depth + 1);
+        out.String(summarized ? figures[figure].first : metricNames[metric]);
+        out.Raw(": ");
+
+        if (summarized)
+        {
+            out.Raw("[");
+            out.Indent(depth + 2);
+            out.Number(figures[figure++].second);
+            out.Indent(depth + 1);
+            out.Raw("]");
+            continue;
+        }
+
+        //Streamed series are exported as their aggregates, keys in the same sorted order nlohmann used
+        if (streamed)
+        {
+            const StreamingStats &stats = aggregates[asset][metric];
+            const pair<const char *, double> fields[] = {
+                {"Avg", stats.GetMean()},
+                {"Count", static_cast<double>(stats.GetCount())},
+                {"Max", stats.GetMax()},
+                {"Min", stats.GetMin()},
+                {"P50", stats.Quantile(0.5)},
+                {"P90", stats.Quantile(0.9)},
+                {"P99", stats.Quantile(0.99)},
+                {"Total", stats.GetSum()},
+                {"Variance", stats.GetVariance()}};
+            out.Raw("{");
+            for (size_t i = 0; i < size(fields); i++)
+            {
+                out.Raw(i == 0 ? "" : ",");
+                out.Indent(depth + 2);
+                out.String(fields[i].first);
+                out.Raw(": ");
+                if (i == 1)
+                    out.Integer(static_cast<long long>(stats.GetCount()));
+                else
+                    out.Number(fields[i].second);
+            }
+            out.Indent(depth + 1);
+            out.Raw("}");
+            continue;
+        }
+
+        const vector<double> &values = metrics[asset][metric];
+        out.Raw("[");
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            out.Raw(i == 0 ? "" : ",");
+            out.Indent(depth + 2);
+            out.Number(values[i]);
+        }
+        out.Indent(depth + 1);
+        out.Raw("]");
     }
+    if (first)
+        return false;
+    out.Indent(depth);
+    out.Raw("}");
+    return true;
+}
+
+/**
+ * @brief Exports all the granular data to a json file
+ * The text is streamed from the merged table through a fixed buffer, no JSON document is built.
+ */
+void MetricsHandler::SaveMetricsToJson(const string &filename) const
+{
+    string relativePath = TimestampedPath(filename);
+
+    Merge();
 
     //Check to see if the file was made properly, if so, generate our JSON
-    ofstream file(relativePath); // Use the constructed path
-    if (file.is_open())
+    JsonWriter out(relativePath); // Use the constructed path
+    if (!out.IsOpen())
+    {
+        cout << "Unable to open file: " << relativePath << endl;
+        return;
+    }
+
+    vector<int> metricOrder = SortedByName(metricNames);
+    bool any = false;
+    out.Raw("{");
+    for (int asset : SortedByName(assetNames))
     {
-        file << json.dump(4); // Pretty printing with 4 spaces indent
-        file.close();
+        // The separator is only written once the asset turns out to have series
+        if (WriteAssetJson(out, asset, metricOrder, 1, any ? "," : ""))
+            any = true;
+    }
+    out.Raw(any ? "\n}" : "}");
+
+    if (out.Flush())
         cout << "Metrics saved to " << relativePath << endl;
+    else
+        cout << "Unable to write file: " << relativePath << endl;
+}
+
+/**
+ * @brief Exports the granular data as one json file per asset, written in parallel.
+ * Files go to a timestamped directory, each holding {"<asset>": {...}} like the single-file export.
+ * @param filename The filename the directory is named after, e.g. test.json gives ./test_<timestamp>/
+ * @param workers Threads writing files, 0 sizes the pool to the hardware.
+ */
+void MetricsHandler::SaveMetricsToJsonShards(const string &filename, unsigned int workers) const
+{
+    string relativePath = TimestampedPath(filename);
+    string directory = relativePath.substr(0, relativePath.find_last_of('.'));
+
+    Merge();
+
+    error_code error;
+    filesystem::create_directories(directory, error);
+    if (error)
+    {
+        cout << "Unable to create directory: " << directory << endl;
+        return;
+    }
+
+    vector<int> metricOrder = SortedByName(metricNames);
+    // Assets without any series get no file
+    vector<int> exported;
+    for (int asset = 0; asset < static_cast<int>(assetNames.size()); asset++)
+    {
+        bool streamed = asset < static_cast<int>(aggregates.size()) &&
+                        any_of(aggregates[asset].begin(), aggregates[asset].end(), [](const StreamingStats &stats)
+                               { return stats.GetCount() > 0; });
+        if (streamed || any_of(metricOrder.begin(), metricOrder.end(), [this, asset](int metric)
+                               { return HasSamples(asset, metric); }))
+            exported.push_back(asset);
     }
+
+    atomic<bool> failed{false};
+    WorkerPool pool(workers);
+    pool.parallelFor(0, static_cast<int>(exported.size()), 1, [&](int begin, int end, unsigned int)
+                     {
+                         for (int i = begin; i < end; i++)
+                         {
+                             int asset = exported[i];
+                             JsonWriter out(directory + "/" + assetNames[asset] + ".json");
+                             out.Raw("{");
+                             bool written = WriteAssetJson(out, asset, metricOrder, 1, "");
+                             out.Raw(written ? "\n}" : "}");
+                             if (!out.Flush())
+                                 failed = true;
+                         }
+                     });
+
+    if (failed)
+        cout << "Unable to write every file in: " << directory << endl;
     else
+        cout << "Metrics saved to " << directory << endl;
+}
+
+/**
+ * @brief Exports the granular data as a binary columnar file, one typed array per asset/metric.
+ * Streamed series hold no samples, so a streaming handler writes nothing and says so, save those as JSON.
+ * @param filename The filename, timestamped like the JSON export.
+ * @param encoding Column encoding, one of ColumnarFile::ENCODING.
+ */
+void MetricsHandler::SaveMetricsToColumnar(const string &filename, int encoding) const
+{
+    if (streaming)
+    {
+        cout << "Streamed metrics hold no samples to save as columnar, save them as JSON" << endl;
+        return;
+    }
+    string relativePath = TimestampedPath(filename);
+
+    Merge();
+
+    ColumnarWriter writer;
+    for (size_t asset = 0; asset < metrics.size(); asset++)
+    {
+        for (size_t metric = 0; metric < metrics[asset].size(); metric++)
+        {
+            const vector<double> &values = metrics[asset][metric];
+            if (!values.empty())
+                writer.AddColumn(assetNames[asset], metricNames[metric], values.data(), values.size(), encoding);
+        }
+    }
+
+    try
+    {
+        writer.Write(relativePath);
+        cout << "Metrics saved to " << relativePath << endl;
+    }
+    catch (const runtime_error &e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+/**
+ * @brief Exports the rollups as CSV, one row per bucket, ordered by asset, metric, width and tick.
+ * @param filename The filename, timestamped like the JSON export.
+ */
+void MetricsHandler::SaveRollupsToCsv(const string &filename) const
+{
+    string relativePath = TimestampedPath(filename);
+    ofstream out(relativePath);
+    if (!out.is_open())
     {
         cout << "Unable to open file: " << relativePath << endl;
+        return;
+    }
+
+    Merge();
+    vector<int> assetOrder, metricOrder;
+    {
+        lock_guard<mutex> lock(registryMtx);
+        assetOrder = SortedByName(assetNames);
+        metricOrder = SortedByName(metricNames);
     }
+    lock_guard<mutex> lock(shardsMtx);
+    const auto &widths = rollups.GetWidths();
+    out << "Asset,Metric,Width,StartTick,Count,Sum,Min,Max,Mean\n";
+    out << setprecision(17);
+    for (int asset : assetOrder)
+    {
+        for (int metric : metricOrder)
+        {
+            for (size_t level = 0; level < widths.size(); level++)
+            {
+                for (const auto &bucket : rollups.GetBuckets(asset, metric, level))
+                {
+                    out << assetNames[asset] << ',' << metricNames[metric] << ',' << widths[level] << ',' << bucket.start << ','
+                        << bucket.count << ',' << bucket.sum << ',' << bucket.min << ',' << bucket.max << ',' << bucket.Mean() << '\n';
+                }
+            }
+        }
+    }
+
+    if (out.flush())
+        cout << "Rollups saved to " << relativePath << endl;
+    else
+        cout << "Unable to write file: " << relativePath << endl;
 }
@@ -0,0 +1,204 @@
+/**
+ * @file metricsserver.cpp
+ * @brief Implementation of MetricsServer, a Prometheus scrape endpoint for a run in progress.
+ *
+ * The server binds to 127.0.0.1 only and answers one request per connection on its own
+ * thread. GET /metrics returns the LiveMetrics exposition, every other path is a 404. The
+ * simulation threads never wait on the server, a scrape only reads atomics. A client gets
+ * SERVER_READ_MS to send its request line, so an idle connection cannot hold up later
+ * scrapes or Stop.
+ */
+
+#include "../inlcude/utils/metricsserver.h"
+#include <chrono>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+#ifdef _WIN32
+    void CloseSocket(intptr_t socket)
+    {
+        closesocket(static_cast<SOCKET>(socket));
+    }
+#else
+    void CloseSocket(intptr_t socket)
+    {
+        close(static_cast<int>(socket));
+    }
+#endif
+
+    // Sends the whole buffer, a failed send just ends the response
+    void SendAll(intptr_t socket, const string &data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            auto result = send(socket, data.data() + sent, static_cast<int>(data.size() - sent), 0);
+            if (result <= 0)
+                return;
+            sent += static_cast<size_t>(result);
+        }
+    }
+}
+
+/**
+ * @brief Creates the listening socket.
+ * @param liveMetrics Counters served at /metrics.
+ * @param port Port on 127.0.0.1, 0 picks a free one.
+ * @throws std::runtime_error if the port cannot be bound.
+ */
+MetricsServer::MetricsServer(LiveMetrics &liveMetrics, unsigned short port) : liveMetrics(liveMetrics), port(port), listener(-1), running(false)
+{
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+        throw runtime_error("Unable to initialize sockets");
+#endif
+    listener = static_cast<intptr_t>(socket(AF_INET, SOCK_STREAM, 0));
+    if (listener < 0)
+        throw runtime_error("Unable to create socket");
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, 16) != 0 ||
+        getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length) != 0)
+    {
+        CloseSocket(listener);
+        throw runtime_error("Unable to listen on port " + to_string(port));
+    }
+    this->port = ntohs(address.sin_port);
+}
+
+/**
+ * @brief Stops the server and closes the socket.
+ */
+MetricsServer::~MetricsServer()
+{
+    Stop();
+    CloseSocket(listener);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+/**
+ * @brief Starts answering requests on a background thread.
+ */
+void MetricsServer::Start()
+{
+    if (running.exchange(true))
+        return;
+    thread = std::thread([this]()
+                         { this->serve(); });
+}
+
+/**
+ * @brief Stops answering requests and joins the server thread, within SERVER_POLL_MS.
+ */
+void MetricsServer::Stop()
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+}
+
+/**
+ * @brief Returns the port the server listens on.
+ * @return unsigned short The port, the one picked by the system if 0 was asked for.
+ */
+unsigned short MetricsServer::GetPort() const
+{
+    return port;
+}
+
+/**
+ * @brief Accepts connections until stopped, waking regularly to check whether it should stop.
+ */
+void MetricsServer::serve()
+{
+    while (running)
+    {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(listener, &readable);
+        timeval timeout{0, SERVER_POLL_MS * 1000};
+        if (select(static_cast<int>(listener) + 1, &readable, nullptr, nullptr, &timeout) <= 0)
+            continue;
+
+        intptr_t client = static_cast<intptr_t>(accept(listener, nullptr, nullptr));
+        if (client < 0)
+            continue;
+        // A client that stops reading cannot block the response either
+#ifdef _WIN32
+        DWORD sendTimeout = SERVER_READ_MS;
+#else
+        timeval sendTimeout{SERVER_READ_MS / 1000, (SERVER_READ_MS % 1000) * 1000};
+#endif
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char *>(&sendTimeout), sizeof(sendTimeout));
+        respond(client);
+        CloseSocket(client);
+    }
+}
+
+/**
+ * @brief Reads a request line and answers it. Gives up on clients that are too slow, send too much or are still
+ * sending when the server stops.
+ * @param client The connected socket.
+ */
+void MetricsServer::respond(intptr_t client)
+{
+    string request;
+    char buffer[1024];
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(SERVER_READ_MS);
+    while (request.find('\n') == string::npos)
+    {
+        auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+        if (!running || left <= 0 || request.size() >= SERVER_REQUEST_BYTES)
+            return;
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(client, &readable);
+        timeval timeout{0, static_cast<long>(min<long long>(left, SERVER_POLL_MS) * 1000)};
+        int ready = select(static_cast<int>(client) + 1, &readable, nullptr, nullptr, &timeout);
+        if (ready < 0)
+            return;
+        if (ready == 0)
+            continue;
+        auto received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+            return;
+        request.append(buffer, static_cast<size_t>(received));
+    }
+    string line = request.substr(0, request.find_first_of("\r\n"));
+
+    string status = "404 Not Found";
+    string type = "text/plain";
+    string body = "Not found\n";
+    if (line.rfind("GET /metrics ", 0) == 0 || line.rfind("GET /metrics?", 0) == 0 || line == "GET /metrics")
+    {
+        status = "200 OK";
+        type = "text/plain; version=0.0.4; charset=utf-8";
+        body = liveMetrics.Render();
+    }
+
+    SendAll(client, "HTTP/1.1 " + status + "\r\nContent-Type: " + type + "\r\nContent-Length: " + to_string(body.size()) +
+                        "\r\nConnection: close\r\n\r\n" + body);
+}
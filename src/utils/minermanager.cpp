@@ -1,6 +1,10 @@
 /**
  * @file minermanager.cpp
  * Implementation of the MinerManager class, managing miners in the simulation.
+ *
+ * Miners are kept in a dense structure-of-arrays store: one contiguous column per field,
+ * indexed directly by miner id. Whole blocks of miners are advanced by a batch kernel whose
+ * countdown pass is a branch-free loop the compiler turns into SIMD code.
  */
 
 #include "../inlcude/utils/minermanager.h"
@@ -11,40 +15,58 @@ using namespace std;
  * @brief Constructs a new Miner Manager object.
  *
  * Initializes the miner manager with a specific number of miners. Each miner is
- * instantiated and stored in a map with their ID as the key.
+ * instantiated and its fields are stored in the columns at the index of its ID.
+ * Every miner draws from its own stream keyed by the seed and its ID, so a seed reproduces the fleet.
+ *
+ * A manager can also hold a contiguous slice of a larger fleet: its miners are indexed from zero,
+ * but draw from the streams of their fleet-wide IDs, so a slice reproduces its part of the fleet.
  *
  * @param assets The number of miners to manage.
+ * @param seed Master seed of the simulation.
+ * @param first Fleet-wide ID of the first miner, 0 unless the manager holds a slice of the fleet.
  */
-MinerManager::MinerManager(int assets) : assets(assets)
+MinerManager::MinerManager(int assets, uint64_t seed, int first)
+    : state(assets), time(assets), miningTime(assets), queueStatus(assets), station(assets), load(assets), draws(assets), assets(assets), first(first), seed(seed)
 {
     for (int i = 0; i < assets; i++)
     {
-        miners.emplace(make_pair(i, Miner()));
+        SetMiner(i, Miner(RandomStream(seed, RandomStream::Entity(RandomStream::MINER, first + i))));
     }
 }
 
 /**
- * @brief Retrieves a reference to a miner by their ID.
+ * @brief Retrieves a copy of a miner by their ID.
  *
- * Searches the collection of miners for the one with the specified ID. If the miner
- * is found, returns a reference to it. Throws an exception if no miner with the
- * given ID exists.
+ * Gathers the miner's fields from the fleet columns into a Miner object. Throws an
+ * exception if no miner with the given ID exists.
  *
  * @param id The ID of the miner to retrieve.
- * @return Miner& A reference to the requested miner.
+ * @return Miner A snapshot of the requested miner.
  * @throws std::out_of_range if a miner with the specified ID does not exist.
  */
-Miner &MinerManager::GetMiner(int id)
+Miner MinerManager::GetMiner(int id) const
 {
-    auto miner = miners.find(id);
-    if (miner != miners.end())
-    {
-        return miner->second;
-    }
-    else
-    {
-        throw std::out_of_range("Invalid miner ID");
-    }
+    CheckID(id);
+    return Miner(time[id], miningTime[id], state[id], queueStatus[id], station[id], load[id],
+                 RandomStream(seed, RandomStream::Entity(RandomStream::MINER, first + id), draws[id]));
+}
+
+/**
+ * @brief Stores a miner's fields into the fleet columns at the given ID.
+ * @param id The ID of the miner to overwrite.
+ * @param miner The miner whose fields are stored.
+ * @throws std::out_of_range if a miner with the specified ID does not exist.
+ */
+void MinerManager::SetMiner(int id, const Miner &miner)
+{
+    CheckID(id);
+    state[id] = miner.GetState();
+    time[id] = miner.GetTime();
+    miningTime[id] = miner.GetMiningTime();
+    queueStatus[id] = miner.GetQueueStatus();
+    station[id] = miner.GetStationID();
+    load[id] = miner.GetLoad();
+    draws[id] = miner.GetRandom().GetCounter();
 }
 
 /**
@@ -56,3 +78,176 @@ int MinerManager::GetAssets()
 {
     return assets;
 }
+
+/**
+ * @brief Returns the fleet-wide ID of the manager's first miner.
+ * @return int 0, unless the manager holds a slice of a larger fleet.
+ */
+int MinerManager::GetFirst() const
+{
+    return first;
+}
+
+/**
+ * @brief Returns the master seed the miners' random streams are keyed by.
+ * @return uint64_t Seed.
+ */
+uint64_t MinerManager::GetSeed() const
+{
+    return seed;
+}
+
+/**
+ * @brief Returns the state column, indexed by miner ID.
+ * @return const int* Pointer to the first miner's state.
+ */
+const int *MinerManager::GetStates() const
+{
+    return state.data();
+}
+
+/**
+ * @brief Returns a miner's queue status. The ID is not range checked.
+ * @param id The ID of the miner.
+ * @return int Queue status.
+ */
+int MinerManager::GetQueueStatus(int id) const
+{
+    return queueStatus[id];
+}
+
+/**
+ * @brief Returns a miner's current station ID. The ID is not range checked.
+ * @param id The ID of the miner.
+ * @return int Station ID.
+ */
+int MinerManager::GetStationID(int id) const
+{
+    return station[id];
+}
+
+/**
+ * @brief Sets a miner's queue status. The ID is not range checked.
+ * @param id The ID of the miner.
+ * @param queueStatus New queue status.
+ */
+void MinerManager::SetQueueStatus(int id, int queueStatus)
+{
+    this->queueStatus[id] = queueStatus;
+}
+
+/**
+ * @brief Sets a miner's current station ID. The ID is not range checked.
+ * @param id The ID of the miner.
+ * @param station New station ID.
+ */
+void MinerManager::SetStation(int id, int station)
+{
+    this->station[id] = station;
+}
+
+/**
+ * @brief Applies Miner::tick to every miner in [begin, end).
+ *
+ * The first pass handles the common case branch-free with bit tests against the state machine's
+ * constant tables: timed miners with time left count down (an unload is flagged COMPLETE on its
+ * last tick), and every miner that is due to change state is flagged. Only the flagged miners
+ * then go through the scalar Miner::tick.
+ *
+ * @param begin ID of the first miner in the block.
+ * @param end One past the ID of the last miner in the block.
+ */
+void MinerManager::TickBlock(int begin, int end)
+{
+    int *st = state.data();
+    int *tm = time.data();
+    int *qs = queueStatus.data();
+    unsigned char transition[KERNEL_BLOCK];
+
+    for (int base = begin; base < end; base += KERNEL_BLOCK)
+    {
+        int n = min(KERNEL_BLOCK, end - base);
+        int *s = st + base;
+        int *t = tm + base;
+        int *q = qs + base;
+
+        for (int j = 0; j < n; j++)
+        {
+            int timed = (MinerMachine::TIMED >> s[j]) & 1;
+            int counting = timed & (t[j] > 0);
+            // An unload completes on the last tick of its countdown
+            int completing = counting & (t[j] == 1) & static_cast<int>((MinerMachine::COMPLETING >> s[j]) & 1);
+            int signalled = (MinerMachine::SIGNALLED >> (s[j] * MINER_STATUS_COUNT + q[j])) & 1;
+
+            t[j] -= counting;
+            q[j] = completing ? static_cast<int>(Miner::COMPLETE) : q[j];
+            transition[j] = static_cast<unsigned char>((timed & !counting) | signalled);
+        }
+
+        for (int j = 0; j < n; j++)
+        {
+            if (transition[j])
+            {
+                Miner miner = GetMiner(base + j);
+                miner.tick();
+                SetMiner(base + j, miner);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Writes the seed and every fleet column to a checkpoint.
+ * @param out The checkpoint being written.
+ */
+void MinerManager::SaveCheckpoint(CheckpointWriter &out) const
+{
+    out.Write<int32_t>(assets);
+    out.Write(seed);
+    out.WriteArray(state);
+    out.WriteArray(time);
+    out.WriteArray(miningTime);
+    out.WriteArray(queueStatus);
+    out.WriteArray(station);
+    out.WriteArray(load);
+    out.WriteArray(draws);
+}
+
+/**
+ * @brief Replaces the fleet with the one read from a checkpoint, column by column.
+ * @param in The checkpoint being read.
+ * @throws std::runtime_error if the checkpoint holds a different number of miners.
+ */
+void MinerManager::RestoreCheckpoint(CheckpointReader &in)
+{
+    if (in.Read<int32_t>() != assets)
+        throw runtime_error("Checkpoint holds a different number of miners");
+    seed = in.Read<uint64_t>();
+    in.ReadArray(state);
+    in.ReadArray(time);
+    in.ReadArray(miningTime);
+    in.ReadArray(queueStatus);
+    in.ReadArray(station);
+    in.ReadArray(load);
+    in.ReadArray(draws);
+    for (const auto *column : {&state, &time, &miningTime, &queueStatus, &station})
+    {
+        if (column->size() != static_cast<size_t>(assets))
+            throw runtime_error("Corrupt checkpoint");
+    }
+    if (load.size() != static_cast<size_t>(assets) || draws.size() != static_cast<size_t>(assets))
+        throw runtime_error("Corrupt checkpoint");
+}
+
+/**
+ * @brief Validates a miner ID.
+ * @param id The ID to check.
+ * @throws std::out_of_range if a miner with the specified ID does not exist.
+ */
+void MinerManager::CheckID(int id) const
+{
+    if (id < 0 || id >= assets)
+    {
+        throw std::out_of_range("Invalid miner ID");
+    }
+}
@@ -0,0 +1,159 @@
+/**
+ * @file randomstream.cpp
+ * @brief Implementation of RandomStream, counter-based random streams keyed by (seed, entity).
+ *
+ * Each draw encrypts a counter with the Philox4x32-10 bijection: the master seed is the key and
+ * the counter block holds the draw index and the entity. Streams are therefore independent,
+ * cost nothing to create, and need no syscall or state seeding. Values are derived with integer
+ * arithmetic and exact double scaling only, so a seed gives bit-identical draws on every platform.
+ */
+
+#include "../inlcude/utils/randomstream.h"
+
+using namespace std;
+
+namespace
+{
+    const uint32_t PHILOX_M0 = 0xD2511F53u;
+    const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+    const uint32_t PHILOX_W0 = 0x9E3779B9u;
+    const uint32_t PHILOX_W1 = 0xBB67AE85u;
+
+    // 53 random bits scaled into [0, 1)
+    double unit(uint32_t high, uint32_t low)
+    {
+        uint64_t bits = ((static_cast<uint64_t>(high) << 32) | low) >> 11;
+        return static_cast<double>(bits) * (1.0 / 9007199254740992.0);
+    }
+}
+
+/**
+ * @brief Constructs a stream.
+ * @param seed Master seed of the simulation.
+ * @param entity Entity the stream belongs to, see Entity().
+ * @param counter Index of the next draw, nonzero when a stream is restored.
+ */
+RandomStream::RandomStream(uint64_t seed, uint64_t entity, uint64_t counter) : seed(seed), entity(entity), counter(counter)
+{
+}
+
+/**
+ * @brief Builds the entity word of a stream.
+ * @param kind One of RandomStream::KIND.
+ * @param id ID of the miner or station.
+ * @return uint64_t Entity word.
+ */
+uint64_t RandomStream::Entity(int kind, int id)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(kind)) << 32) | static_cast<uint32_t>(id);
+}
+
+/**
+ * @brief Generates the 128-bit block for the current counter and advances the counter.
+ * @param out Receives four random words.
+ */
+void RandomStream::block(uint32_t out[4])
+{
+    uint32_t ctr[4] = {static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32),
+                       static_cast<uint32_t>(entity), static_cast<uint32_t>(entity >> 32)};
+    uint32_t key[2] = {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+
+    for (int round = 0; round < PHILOX_ROUNDS; round++)
+    {
+        uint64_t product0 = static_cast<uint64_t>(PHILOX_M0) * ctr[0];
+        uint64_t product1 = static_cast<uint64_t>(PHILOX_M1) * ctr[2];
+        uint32_t next[4] = {static_cast<uint32_t>(product1 >> 32) ^ ctr[1] ^ key[0], static_cast<uint32_t>(product1),
+                            static_cast<uint32_t>(product0 >> 32) ^ ctr[3] ^ key[1], static_cast<uint32_t>(product0)};
+        for (int i = 0; i < 4; i++)
+            ctr[i] = next[i];
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+    for (int i = 0; i < 4; i++)
+        out[i] = ctr[i];
+    counter++;
+}
+
+/**
+ * @brief Draws a uniform real number. Uses one counter.
+ * @param low Lower bound, inclusive.
+ * @param high Upper bound, exclusive.
+ * @return double The draw.
+ */
+double RandomStream::Uniform(double low, double high)
+{
+    uint32_t words[4];
+    block(words);
+    return low + (high - low) * unit(words[0], words[1]);
+}
+
+/**
+ * @brief Draws a uniform integer. Uses one counter.
+ * @param low Lower bound, inclusive.
+ * @param high Upper bound, inclusive.
+ * @return int The draw.
+ */
+int RandomStream::UniformInt(int low, int high)
+{
+    uint32_t words[4];
+    block(words);
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(high) - low) + 1;
+    // Multiply-shift of 32 random bits, range is at most 2^32 so the product fits. The bias is at most range / 2^32
+    uint64_t scaled = (static_cast<uint64_t>(words[0]) * range) >> 32;
+    return static_cast<int>(low + static_cast<int64_t>(scaled));
+}
+
+/**
+ * @brief Draws a batch of uniform real numbers, two per counter.
+ * @param out Receives the draws.
+ * @param count Number of draws.
+ * @param low Lower bound, inclusive.
+ * @param high Upper bound, exclusive.
+ */
+void RandomStream::Fill(double *out, size_t count, double low, double high)
+{
+    uint32_t words[4];
+    for (size_t i = 0; i < count; i += 2)
+    {
+        block(words);
+        out[i] = low + (high - low) * unit(words[0], words[1]);
+        if (i + 1 < count)
+            out[i + 1] = low + (high - low) * unit(words[2], words[3]);
+    }
+}
+
+/**
+ * @brief Returns the master seed of the stream.
+ * @return uint64_t Seed.
+ */
+uint64_t RandomStream::GetSeed() const
+{
+    return seed;
+}
+
+/**
+ * @brief Returns the entity the stream belongs to.
+ * @return uint64_t Entity word.
+ */
+uint64_t RandomStream::GetEntity() const
+{
+    return entity;
+}
+
+/**
+ * @brief Returns the index of the next draw.
+ * @return uint64_t Counter.
+ */
+uint64_t RandomStream::GetCounter() const
+{
+    return counter;
+}
+
+/**
+ * @brief Moves the stream to a given draw index.
+ * @param counter Index of the next draw.
+ */
+void RandomStream::SetCounter(uint64_t counter)
+{
+    this->counter = counter;
+}
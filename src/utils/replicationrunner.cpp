@@ -0,0 +1,213 @@
+/**
+ * @file replicationrunner.cpp
+ * @brief Implementation of ReplicationRunner, independent Monte Carlo replications of the simulation.
+ *
+ * Every replication builds its own miners, stations, metrics handler and tick handler from its
+ * own seed, so replications share no state and run side by side on a worker pool, one per
+ * worker, scaling with the number of cores. Each replication is reduced to fleet-wide outcomes
+ * per metric. Their means across replications are reported with Student t confidence intervals.
+ */
+
+#include "../inlcude/utils/replicationrunner.h"
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    // Two-sided 95% Student t critical values for 1 to 30 degrees of freedom
+    const double T_TABLE[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                              2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                              2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+}
+
+/**
+ * @brief Constructs a runner.
+ * @param miners Number of miners in every replication.
+ * @param stations Number of stations in every replication.
+ * @param replications Number of replications.
+ * @param seed Master seed. Replication r runs with seed + r, so any replication can be rerun alone.
+ * @param workers Replications run at once, 0 sizes the pool to the hardware.
+ */
+ReplicationRunner::ReplicationRunner(int miners, int stations, int replications, uint64_t seed, unsigned int workers)
+    : miners(miners), stations(stations), replications(replications), seed(seed), workers(workers), engine(TickHandler::TICK), horizon(MAX_TICK)
+{
+}
+
+/**
+ * @brief Selects the engine every replication runs with.
+ * @param engine One of TickHandler::ENGINE.
+ */
+void ReplicationRunner::SetEngine(int engine)
+{
+    this->engine = engine;
+}
+
+/**
+ * @brief Sets the number of ticks every replication simulates.
+ * @param ticks Horizon in ticks.
+ */
+void ReplicationRunner::SetHorizon(int ticks)
+{
+    horizon = ticks;
+}
+
+/**
+ * @brief Runs every replication to the horizon and summarizes their outcomes.
+ */
+void ReplicationRunner::Run()
+{
+    outcomes.assign(replications, {});
+    WorkerPool pool(workers);
+    pool.parallelFor(0, replications, 1, [this](int begin, int end, unsigned int)
+                     {
+                         for (int replication = begin; replication < end; replication++)
+                             outcomes[replication] = runReplication(replication);
+                     });
+    summarize();
+}
+
+/**
+ * @brief Runs one unpaced replication on the calling thread.
+ *
+ * The replication's streaming aggregates are reduced to each metric's fleet-wide total and average.
+ *
+ * @param replication Index of the replication.
+ * @return map<string, double> Outcomes by name, e.g. "DistanceTraveled-Total".
+ */
+map<string, double> ReplicationRunner::runReplication(int replication) const
+{
+    Simulation simulation(miners, stations, seed + replication);
+    simulation.SetEngine(engine);
+    simulation.SetHorizon(horizon);
+    simulation.Run();
+
+    map<string, double> result;
+    for (const auto &[name, stats] : simulation.GetMetrics().GetAggregatesByMetric())
+    {
+        result[name + "-Total"] = stats.GetSum();
+        result[name + "-Avg"] = stats.GetMean();
+    }
+    return result;
+}
+
+/**
+ * @brief Reduces the replications' outcomes to means and confidence intervals, in name order.
+ */
+void ReplicationRunner::summarize()
+{
+    map<string, StreamingStats> byName;
+    // Replications are folded in index order, the summary does not depend on which finished first
+    for (const auto &outcome : outcomes)
+    {
+        for (const auto &[name, value] : outcome)
+            byName[name].Add(value);
+    }
+
+    summaries.clear();
+    for (const auto &[name, stats] : byName)
+    {
+        size_t n = stats.GetCount();
+        double stddev = sqrt(stats.GetVariance());
+        double half = n > 1 ? StudentT(n - 1) * stddev / sqrt(static_cast<double>(n)) : 0.0;
+        summaries.push_back({name, n, stats.GetMean(), stddev, stats.GetMean() - half, stats.GetMean() + half});
+    }
+}
+
+/**
+ * @brief Returns the summaries of the last Run.
+ * @return const vector<Summary>& One summary per outcome, in name order.
+ */
+const vector<ReplicationRunner::Summary> &ReplicationRunner::GetSummaries() const
+{
+    return summaries;
+}
+
+/**
+ * @brief Two-sided 95% critical value of Student's t distribution.
+ * Tabulated up to 30 degrees of freedom, beyond that the Cornish-Fisher expansion around the normal value is used.
+ * @param degrees Degrees of freedom, at least 1.
+ * @return double Critical value.
+ */
+double ReplicationRunner::StudentT(size_t degrees)
+{
+    if (degrees == 0)
+        return 0.0;
+    if (degrees <= size(T_TABLE))
+        return T_TABLE[degrees - 1];
+    double z = 1.959964;
+    double df = static_cast<double>(degrees);
+    return z + (z * z * z + z) / (4.0 * df) + (5.0 * pow(z, 5) + 16.0 * z * z * z + 3.0 * z) / (96.0 * df * df);
+}
+
+/**
+ * @brief Lists the summaries, formatted for console output.
+ */
+void ReplicationRunner::ListSummaries() const
+{
+    cout << "Replications: " << replications << " (seeds " << seed << " to " << seed + replications - 1 << ")" << endl;
+    for (const auto &summary : summaries)
+    {
+        cout << "  " << summary.name
+             << " - Mean: " << summary.mean
+             << ", StdDev: " << summary.stddev
+             << ", 95% CI: [" << summary.low << ", " << summary.high << "]" << endl;
+    }
+}
+
+/**
+ * @brief Exports the summaries to a json file, timestamped like the metrics export.
+ * @param filename The filename.
+ */
+void ReplicationRunner::SaveSummariesToJson(const string &filename) const
+{
+    string relativePath = MetricsHandler::TimestampedPath(filename);
+    JsonWriter out(relativePath);
+    if (!out.IsOpen())
+    {
+        cout << "Unable to open file: " << relativePath << endl;
+        return;
+    }
+
+    out.Raw("{");
+    out.Indent(1);
+    out.Raw("\"Replications\": ");
+    out.Integer(replications);
+    out.Raw(",");
+    out.Indent(1);
+    out.Raw("\"Seed\": ");
+    out.Unsigned(seed);
+    out.Raw(",");
+    out.Indent(1);
+    out.Raw("\"Summaries\": {");
+    for (size_t i = 0; i < summaries.size(); i++)
+    {
+        const Summary &summary = summaries[i];
+        const pair<const char *, double> fields[] = {
+            {"High", summary.high}, {"Low", summary.low}, {"Mean", summary.mean}, {"StdDev", summary.stddev}};
+        out.Raw(i == 0 ? "" : ",");
+        out.Indent(2);
+        out.String(summary.name);
+        out.Raw(": {");
+        for (size_t j = 0; j < size(fields); j++)
+        {
+            out.Raw(j == 0 ? "" : ",");
+            out.Indent(3);
+            out.String(fields[j].first);
+            out.Raw(": ");
+            out.Number(fields[j].second);
+        }
+        out.Indent(2);
+        out.Raw("}");
+    }
+    if (!summaries.empty())
+        out.Indent(1);
+    out.Raw("}");
+    out.Indent(0);
+    out.Raw("}");
+
+    if (out.Flush())
+        cout << "Replication summaries saved to " << relativePath << endl;
+    else
+        cout << "Unable to write file: " << relativePath << endl;
+}
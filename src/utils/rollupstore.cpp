@@ -0,0 +1,189 @@
+/**
+ * @file rollupstore.cpp
+ * @brief Implementation of RollupStore, time-bucketed count/sum/min/max per metric series.
+ *
+ * Every sample tied to a tick is folded into the bucket holding that tick at each configured
+ * width, for example an hour and a day of 5-minute ticks. Samples mostly arrive in tick order,
+ * so they land in the newest bucket. A sample reaching back before it finds its bucket by binary search.
+ */
+
+#include "../inlcude/utils/rollupstore.h"
+#include "../inlcude/utils/checkpoint.h"
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Constructs a store without widths, it ignores samples until widths are set.
+ */
+RollupStore::RollupStore()
+{
+}
+
+/**
+ * @brief Sets the bucket widths and drops every bucket built so far.
+ * @param widths Bucket widths in ticks, one rollup level each.
+ * @throws std::invalid_argument if a width is not positive.
+ */
+void RollupStore::SetWidths(const vector<int> &widths)
+{
+    for (int width : widths)
+    {
+        if (width < 1)
+            throw invalid_argument("Rollup widths must be at least one tick");
+    }
+    this->widths = widths;
+    series.clear();
+}
+
+/**
+ * @brief Returns the bucket widths, in the order of the rollup levels.
+ * @return const vector<int>& Widths in ticks.
+ */
+const vector<int> &RollupStore::GetWidths() const
+{
+    return widths;
+}
+
+/**
+ * @brief Checks whether any rollup level is configured.
+ * @return true If samples are rolled up.
+ */
+bool RollupStore::IsEnabled() const
+{
+    return !widths.empty();
+}
+
+/**
+ * @brief Folds a sample into its bucket at every width.
+ * @param asset The asset ID.
+ * @param metric The metric ID.
+ * @param tick The tick the sample was recorded at, samples not tied to a tick are ignored.
+ * @param value The sample.
+ */
+void RollupStore::Add(int asset, int metric, int tick, double value)
+{
+    if (tick < 0 || widths.empty())
+        return;
+    if (series.size() <= static_cast<size_t>(asset))
+        series.resize(asset + 1);
+    auto &assetSeries = series[asset];
+    if (assetSeries.size() <= static_cast<size_t>(metric))
+        assetSeries.resize(metric + 1);
+    auto &levels = assetSeries[metric];
+    if (levels.empty())
+        levels.resize(widths.size());
+
+    for (size_t level = 0; level < widths.size(); level++)
+    {
+        auto &buckets = levels[level];
+        int start = tick - tick % widths[level];
+        auto it = buckets.end();
+        if (buckets.empty() || buckets.back().start < start)
+            it = buckets.insert(buckets.end(), {start, 0, 0, 0.0, value, value});
+        else if (buckets.back().start != start)
+        {
+            it = lower_bound(buckets.begin(), buckets.end(), start, [](const RollupBucket &bucket, int tick)
+                             { return bucket.start < tick; });
+            if (it->start != start)
+                it = buckets.insert(it, {start, 0, 0, 0.0, value, value});
+        }
+        else
+            it = buckets.end() - 1;
+
+        it->count++;
+        it->sum += value;
+        it->min = std::min(it->min, value);
+        it->max = std::max(it->max, value);
+    }
+}
+
+/**
+ * @brief Returns the buckets of a series at one width.
+ * @param asset The asset ID.
+ * @param metric The metric ID.
+ * @param level Index of the width in GetWidths.
+ * @return const vector<RollupBucket>& Buckets ordered by start tick, empty if the series has none.
+ */
+const vector<RollupBucket> &RollupStore::GetBuckets(int asset, int metric, size_t level) const
+{
+    static const vector<RollupBucket> none;
+    if (asset < 0 || metric < 0 || static_cast<size_t>(asset) >= series.size() || static_cast<size_t>(metric) >= series[asset].size() ||
+        level >= series[asset][metric].size())
+        return none;
+    return series[asset][metric][level];
+}
+
+/**
+ * @brief Counts the buckets held across every series and width.
+ * @return size_t Bucket count.
+ */
+size_t RollupStore::GetBucketCount() const
+{
+    size_t count = 0;
+    for (const auto &assetSeries : series)
+    {
+        for (const auto &levels : assetSeries)
+        {
+            for (const auto &buckets : levels)
+                count += buckets.size();
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Drops every bucket, the widths stay.
+ */
+void RollupStore::Clear()
+{
+    series.clear();
+}
+
+/**
+ * @brief Writes the widths and every bucket to a checkpoint.
+ * @param out The checkpoint being written.
+ */
+void RollupStore::SaveCheckpoint(CheckpointWriter &out) const
+{
+    out.WriteArray(widths);
+    out.Write<uint64_t>(series.size());
+    for (const auto &assetSeries : series)
+    {
+        out.Write<uint64_t>(assetSeries.size());
+        for (const auto &levels : assetSeries)
+        {
+            out.Write<uint64_t>(levels.size());
+            for (const auto &buckets : levels)
+                out.WriteArray(buckets);
+        }
+    }
+}
+
+/**
+ * @brief Replaces the widths and every bucket with those read from a checkpoint.
+ * @param in The checkpoint being read.
+ * @throws std::runtime_error if a series does not hold one level per width.
+ */
+void RollupStore::RestoreCheckpoint(CheckpointReader &in)
+{
+    in.ReadArray(widths);
+    for (int width : widths)
+    {
+        if (width < 1)
+            throw runtime_error("Corrupt checkpoint");
+    }
+    series.assign(static_cast<size_t>(in.Read<uint64_t>()), {});
+    for (auto &assetSeries : series)
+    {
+        assetSeries.resize(static_cast<size_t>(in.Read<uint64_t>()));
+        for (auto &levels : assetSeries)
+        {
+            levels.resize(static_cast<size_t>(in.Read<uint64_t>()));
+            if (!levels.empty() && levels.size() != widths.size())
+                throw runtime_error("Corrupt checkpoint");
+            for (auto &buckets : levels)
+                in.ReadArray(buckets);
+        }
+    }
+}
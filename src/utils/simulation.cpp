@@ -0,0 +1,61 @@
+/**
+ * @file simulation.cpp
+ * @brief Implementation of Simulation, a self-contained run used by the replication and sweep runners.
+ *
+ * A simulation owns its miners, stations, metrics handler and tick handler. Metrics are kept as
+ * streaming aggregates, so the memory of a run does not grow with its horizon.
+ */
+
+#include "../inlcude/utils/simulation.h"
+
+using namespace std;
+
+/**
+ * @brief Constructs a simulation.
+ * @param miners Number of miners.
+ * @param stations Number of stations.
+ * @param seed Master seed of the run's random streams.
+ */
+Simulation::Simulation(int miners, int stations, uint64_t seed)
+    : minerManager(miners, seed), stationManager(stations, miners),
+      // Runs are the unit of parallelism, each one ticks unpaced on a single worker
+      tickHandler(minerManager, stationManager, 0, 1, metricsHandler)
+{
+    metricsHandler.SetStreaming(true);
+}
+
+/**
+ * @brief Selects the engine of the run.
+ * @param engine One of TickHandler::ENGINE.
+ */
+void Simulation::SetEngine(int engine)
+{
+    tickHandler.SetEngine(engine);
+}
+
+/**
+ * @brief Sets the number of ticks the run simulates.
+ * @param ticks Horizon in ticks.
+ */
+void Simulation::SetHorizon(int ticks)
+{
+    tickHandler.SetHorizon(ticks);
+}
+
+/**
+ * @brief Runs the simulation to its horizon, returning once it is done.
+ */
+void Simulation::Run()
+{
+    tickHandler.start();
+    tickHandler.wait();
+}
+
+/**
+ * @brief Returns the handler the run recorded its metrics into.
+ * @return MetricsHandler& The run's metrics.
+ */
+MetricsHandler &Simulation::GetMetrics()
+{
+    return metricsHandler;
+}
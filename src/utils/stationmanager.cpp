@@ -1,6 +1,11 @@
 /**
  * @file stationmanager.cpp
  * Implements the StationManager class for managing a collection of stations.
+ *
+ * Shortest-queue selection goes through a station-load index, an indexed min-heap of the
+ * reserved queue length at every station. A miner reserves its place in the chosen queue
+ * in the same critical section that picks the station, so two miners can never both take
+ * the last slot of the same "shortest" queue, and selection costs O(log stations).
  */
 
 #include "../inlcude/utils/StationManager.h"
@@ -9,80 +14,92 @@ using namespace std;
 
 /**
  * @brief Constructs a new Station Manager object.
- * Initializes the station manager with a given number of stations.
+ * Initializes the station manager with a given number of stations, whose queues share one node pool
+ * sized for every miner being queued at once.
  * @param assets Number of stations to be initialized.
+ * @param miners Number of miners that can be queued across all stations.
  */
-StationManager::StationManager(int assets) : assets(assets)
+StationManager::StationManager(int assets, int miners)
+    : assets(assets), queueNodes(make_shared<QueueNodePool>(static_cast<size_t>(assets) + miners)),
+      loadHeap(assets), heapPosition(assets), reserved(assets, 0)
 {
     for (int i = 0; i < assets; i++)
     {
-        stations.emplace_back(make_shared<Station>(i));
+        stations.emplace_back(make_shared<Station>(i, queueNodes));
+        // Every queue starts empty, so the identity order is already a valid heap
+        loadHeap[i] = i;
+        heapPosition[i] = i;
     }
 }
 
 /**
  * @brief Retrieves a station by ID.
- * Searches for a station with the specified ID and returns it if found.
+ * Looks up the station with the specified ID and returns it if found.
  * @param id ID of the station to retrieve.
  * @return shared_ptr<Station> Shared pointer to the requested station, or nullptr if not found.
  */
 shared_ptr<Station> StationManager::GetStation(int id)
 {
-    for (auto &station : stations)
-    {
-        if (station->GetID() == id)
-        {
-            return station;
-        }
-    }
-    return nullptr; // Return nullptr if station not found
+    int index = IndexOf(id);
+    return index >= 0 ? stations[index] : nullptr; // Return nullptr if station not found
 }
 
 /**
  * @brief Gets the size of the queue at a specific station.
  * @param id ID of the station.
  * @return size_t Size of the station's queue.
+ * @throws std::invalid_argument if no station has the ID.
  */
 size_t StationManager::GetStationSize(int id)
 {
-    return GetStation(id)->size(); // Assumes GetStation handles nullptr return
+    auto station = GetStation(id);
+    if (!station)
+        throw invalid_argument("Unknown station: " + to_string(id));
+    return station->size();
 }
 
 /**
  * @brief Adds an ID to the queue of the station with the shortest queue.
+ * Ties go to the lowest station index. The place in the queue is reserved atomically with the choice.
  * @param id ID to be added.
  * @return int ID of the station to which the ID was added.
+ * @throws std::runtime_error if the manager has no stations.
  */
 int StationManager::AddToShortestQueue(int id)
 {
-    shared_ptr<Station> targetStation = nullptr;
-    size_t minSize = numeric_limits<size_t>::max();
-
-    for (auto &station : stations)
-    {
-        size_t currentSize = station->size();
-        if (currentSize < minSize)
-        {
-            minSize = currentSize;
-            targetStation = station;
-        }
-    }
-
-    if (targetStation != nullptr)
+    if (assets <= 0)
+        throw runtime_error("No station to queue at");
+    int target;
     {
-        targetStation->add(id);
+        lock_guard<mutex> lock(stationsMtx);
+        target = loadHeap[0];
+        reserved[target]++;
+        SiftDown(0);
     }
 
-    return targetStation->GetID();
+    stations[target]->add(id);
+    return stations[target]->GetID();
 }
 
 /**
- * @brief Removes the front ID from the queue of a specific station.
+ * @brief Removes the front ID from the queue of a specific station and releases its reservation.
  * @param id ID of the station from which to pop the queue.
+ * @throws std::invalid_argument if no station has the ID.
  */
 void StationManager::PopStationQueue(int id)
 {
-    GetStation(id)->remove();
+    int index = IndexOf(id);
+    if (index < 0)
+        throw invalid_argument("Unknown station: " + to_string(id));
+    {
+        lock_guard<mutex> lock(stationsMtx);
+        if (reserved[index] > 0)
+        {
+            reserved[index]--;
+            SiftUp(heapPosition[index]);
+        }
+    }
+    stations[index]->remove();
 }
 
 /**
@@ -93,3 +110,129 @@ int StationManager::GetAssets() const
 {
     return assets;
 }
+
+/**
+ * @brief Writes every station's ID, queue contents and reservation count to a checkpoint.
+ * @param out The checkpoint being written.
+ */
+void StationManager::SaveCheckpoint(CheckpointWriter &out)
+{
+    lock_guard<mutex> lock(stationsMtx);
+    out.Write<int32_t>(assets);
+    for (int i = 0; i < assets; i++)
+    {
+        out.Write<int32_t>(stations[i]->GetID());
+        out.WriteArray(stations[i]->contents());
+        out.Write<uint64_t>(reserved[i]);
+    }
+}
+
+/**
+ * @brief Replaces every station's queue with the one read from a checkpoint and rebuilds the load index.
+ * @param in The checkpoint being read.
+ * @throws std::runtime_error if the checkpoint holds a different number of stations.
+ */
+void StationManager::RestoreCheckpoint(CheckpointReader &in)
+{
+    lock_guard<mutex> lock(stationsMtx);
+    if (in.Read<int32_t>() != assets)
+        throw runtime_error("Checkpoint holds a different number of stations");
+
+    vector<int> ids;
+    for (int i = 0; i < assets; i++)
+    {
+        stations[i]->SetID(in.Read<int32_t>());
+        in.ReadArray(ids);
+        stations[i]->clear();
+        for (int id : ids)
+            stations[i]->add(id);
+        reserved[i] = static_cast<size_t>(in.Read<uint64_t>());
+    }
+
+    for (int i = 0; i < assets; i++)
+    {
+        loadHeap[i] = i;
+        heapPosition[i] = i;
+    }
+    for (int pos = assets / 2 - 1; pos >= 0; pos--)
+        SiftDown(pos);
+}
+
+/**
+ * @brief Maps a station ID to its index in the manager.
+ * Stations keep the index they were created with as their ID unless it was changed with SetID.
+ * @param id ID of the station.
+ * @return int Index of the station, or -1 if not found.
+ */
+int StationManager::IndexOf(int id) const
+{
+    if (id >= 0 && id < assets && stations[id]->GetID() == id)
+    {
+        return id;
+    }
+    for (int i = 0; i < assets; i++)
+    {
+        if (stations[i]->GetID() == id)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Orders stations by reserved queue length, then by index.
+ * @return true If station a is less loaded than station b.
+ */
+bool StationManager::LessLoaded(int a, int b) const
+{
+    return reserved[a] < reserved[b] || (reserved[a] == reserved[b] && a < b);
+}
+
+/**
+ * @brief Moves a heap entry towards the root until the heap order holds.
+ * @param pos Heap position of the entry.
+ */
+void StationManager::SiftUp(int pos)
+{
+    while (pos > 0)
+    {
+        int parent = (pos - 1) / 2;
+        if (!LessLoaded(loadHeap[pos], loadHeap[parent]))
+            break;
+        SwapHeap(pos, parent);
+        pos = parent;
+    }
+}
+
+/**
+ * @brief Moves a heap entry towards the leaves until the heap order holds.
+ * @param pos Heap position of the entry.
+ */
+void StationManager::SiftDown(int pos)
+{
+    while (true)
+    {
+        int smallest = pos;
+        int left = 2 * pos + 1;
+        int right = left + 1;
+        if (left < assets && LessLoaded(loadHeap[left], loadHeap[smallest]))
+            smallest = left;
+        if (right < assets && LessLoaded(loadHeap[right], loadHeap[smallest]))
+            smallest = right;
+        if (smallest == pos)
+            break;
+        SwapHeap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+/**
+ * @brief Swaps two heap entries and keeps the position index in step.
+ */
+void StationManager::SwapHeap(int a, int b)
+{
+    swap(loadHeap[a], loadHeap[b]);
+    heapPosition[loadHeap[a]] = a;
+    heapPosition[loadHeap[b]] = b;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file statskernel.cpp
+ * @brief Implementation of StatsKernel, one-pass reductions and selection-based percentiles.
+ *
+ * Count, sum, min, max, the optional sum of squares and the positive-only sum are reduced in one
+ * pass. Each quantity keeps STATS_LANES independent accumulators that are combined at the end, so
+ * the loop has no dependency from one element to the next and no branches, and the compiler
+ * vectorizes it without being allowed to reorder floating-point sums. Percentiles come from
+ * nth_element, linear time per percentile instead of a sort of the whole series.
+ */
+
+#include "../inlcude/utils/statskernel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace
+{
+    template <bool Squares>
+    SeriesSummary Reduce(const double *values, size_t count)
+    {
+        double sum[STATS_LANES] = {}, squares[STATS_LANES] = {}, positive[STATS_LANES] = {}, positives[STATS_LANES] = {};
+        double low[STATS_LANES], high[STATS_LANES];
+        fill(low, low + STATS_LANES, numeric_limits<double>::infinity());
+        fill(high, high + STATS_LANES, -numeric_limits<double>::infinity());
+
+        size_t body = count - count % STATS_LANES;
+        for (size_t i = 0; i < body; i += STATS_LANES)
+        {
+            for (int j = 0; j < STATS_LANES; j++)
+            {
+                double v = values[i + j];
+                sum[j] += v;
+                if (Squares)
+                    squares[j] += v * v;
+                low[j] = v < low[j] ? v : low[j];
+                high[j] = v > high[j] ? v : high[j];
+                positive[j] += v > 0.0 ? v : 0.0;
+                positives[j] += v > 0.0 ? 1.0 : 0.0;
+            }
+        }
+        // The tail goes round the same lanes
+        for (size_t i = body; i < count; i++)
+        {
+            size_t j = i - body;
+            double v = values[i];
+            sum[j] += v;
+            if (Squares)
+                squares[j] += v * v;
+            low[j] = min(low[j], v);
+            high[j] = max(high[j], v);
+            positive[j] += v > 0.0 ? v : 0.0;
+            positives[j] += v > 0.0 ? 1.0 : 0.0;
+        }
+
+        SeriesSummary summary{count, 0.0, 0.0, low[0], high[0], 0, 0.0};
+        double positiveCount = 0.0;
+        for (int j = 0; j < STATS_LANES; j++)
+        {
+            summary.sum += sum[j];
+            summary.sumSquares += squares[j];
+            summary.min = min(summary.min, low[j]);
+            summary.max = max(summary.max, high[j]);
+            summary.positiveSum += positive[j];
+            positiveCount += positives[j];
+        }
+        summary.positiveCount = static_cast<size_t>(positiveCount);
+        return summary;
+    }
+}
+
+/**
+ * @brief Returns the mean of the series.
+ * @return double Mean, 0 for an empty series.
+ */
+double SeriesSummary::Mean() const
+{
+    return count > 0 ? sum / count : 0.0;
+}
+
+/**
+ * @brief Returns the sample variance of the series, if its sum of squares was gathered.
+ * @return double Variance, 0 for fewer than two samples.
+ */
+double SeriesSummary::Variance() const
+{
+    if (count < 2)
+        return 0.0;
+    return std::max(0.0, (sumSquares - sum * sum / count) / (count - 1));
+}
+
+/**
+ * @brief Reduces a series in one pass.
+ * @param values First sample.
+ * @param count Number of samples.
+ * @param squares True to also gather the sum of squares.
+ * @return SeriesSummary The summary, min and max are +/- infinity for an empty series.
+ */
+SeriesSummary StatsKernel::Summarize(const double *values, size_t count, bool squares)
+{
+    return squares ? Reduce<true>(values, count) : Reduce<false>(values, count);
+}
+
+/**
+ * @brief Reduces a series in one pass.
+ * @param values The samples.
+ * @param squares True to also gather the sum of squares.
+ * @return SeriesSummary The summary.
+ */
+SeriesSummary StatsKernel::Summarize(const vector<double> &values, bool squares)
+{
+    return Summarize(values.data(), values.size(), squares);
+}
+
+/**
+ * @brief Selects one percentile of a series.
+ * @param values The samples, reordered.
+ * @param q Quantile in [0, 1].
+ * @return double The percentile, 0 for an empty series.
+ */
+double StatsKernel::Percentile(vector<double> &values, double q)
+{
+    double result = 0.0;
+    Percentiles(values, &q, &result, 1);
+    return result;
+}
+
+/**
+ * @brief Selects several percentiles of a series. Each selection only searches above the previous one.
+ * @param values The samples, reordered.
+ * @param quantiles Ascending quantiles in [0, 1].
+ * @param results Receives one percentile per quantile, 0 for an empty series.
+ * @param count Number of quantiles.
+ */
+void StatsKernel::Percentiles(vector<double> &values, const double *quantiles, double *results, size_t count)
+{
+    size_t n = values.size();
+    auto first = values.begin();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (n == 0)
+        {
+            results[i] = 0.0;
+            continue;
+        }
+        double target = min(max(quantiles[i], 0.0), 1.0) * n;
+        size_t rank = static_cast<size_t>(max(1.0, ceil(target))) - 1;
+        auto nth = values.begin() + static_cast<ptrdiff_t>(min(rank, n - 1));
+        // Out of order quantiles fall back to selecting over the whole series
+        nth_element(nth >= first ? first : values.begin(), nth, values.end());
+        first = nth;
+        results[i] = *nth;
+    }
+}
@@ -0,0 +1,319 @@
+/**
+ * @file streamingstats.cpp
+ * @brief Implementation of StreamingStats and QuantileSketch, bounded-memory running aggregates.
+ *
+ * StreamingStats keeps count, sum, min, max and a Welford mean/variance, so memory per metric is
+ * constant no matter how many samples are recorded. Percentiles come from a KLL sketch, whose
+ * size grows only logarithmically with the sample count. Both merge, so aggregates built on
+ * different threads or in different runs combine into the aggregate of all their samples.
+ */
+
+#include "../inlcude/utils/streamingstats.h"
+#include "../inlcude/utils/checkpoint.h"
+
+using namespace std;
+
+/**
+ * @brief Constructs an empty sketch.
+ * @param k Accuracy parameter, the capacity of the top level.
+ */
+QuantileSketch::QuantileSketch(int k) : k(max(8, k)), count(0), compactions(0)
+{
+}
+
+/**
+ * @brief Adds a sample to the sketch.
+ * @param value The sample.
+ */
+void QuantileSketch::Add(double value)
+{
+    if (levels.empty())
+        levels.emplace_back();
+    levels[0].push_back(value);
+    count++;
+    if (levels[0].size() >= Capacity(0))
+        Compress();
+}
+
+/**
+ * @brief Merges another sketch into this one, level by level.
+ * @param other The sketch to merge.
+ */
+void QuantileSketch::Merge(const QuantileSketch &other)
+{
+    if (other.levels.size() > levels.size())
+        levels.resize(other.levels.size());
+    for (size_t h = 0; h < other.levels.size(); h++)
+    {
+        levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+    }
+    count += other.count;
+    Compress();
+}
+
+/**
+ * @brief Estimates the value at a given rank.
+ * @param q Rank between 0 and 1, for example 0.5 for the median.
+ * @return double The estimated quantile, or 0 if the sketch is empty.
+ */
+double QuantileSketch::Quantile(double q) const
+{
+    vector<pair<double, size_t>> weighted;
+    for (size_t h = 0; h < levels.size(); h++)
+    {
+        for (double value : levels[h])
+        {
+            weighted.emplace_back(value, size_t(1) << h);
+        }
+    }
+    if (weighted.empty())
+        return 0.0;
+
+    sort(weighted.begin(), weighted.end());
+    size_t total = 0;
+    for (const auto &item : weighted)
+        total += item.second;
+
+    double target = min(max(q, 0.0), 1.0) * total;
+    size_t cumulative = 0;
+    for (const auto &item : weighted)
+    {
+        cumulative += item.second;
+        if (cumulative >= target)
+            return item.first;
+    }
+    return weighted.back().first;
+}
+
+/**
+ * @brief Returns the number of samples summarized by the sketch.
+ * @return size_t Sample count.
+ */
+size_t QuantileSketch::GetCount() const
+{
+    return count;
+}
+
+/**
+ * @brief Returns the number of items the sketch currently stores.
+ * @return size_t Retained items.
+ */
+size_t QuantileSketch::GetRetained() const
+{
+    size_t retained = 0;
+    for (const auto &level : levels)
+        retained += level.size();
+    return retained;
+}
+
+/**
+ * @brief Capacity of a level. Lower levels shrink geometrically, by 2/3 per level below the top.
+ * @param level The level.
+ * @return size_t Items the level may hold before it is compacted.
+ */
+size_t QuantileSketch::Capacity(size_t level) const
+{
+    size_t depth = levels.size() - 1 - level;
+    return max<size_t>(2, static_cast<size_t>(ceil(k * pow(2.0 / 3.0, static_cast<double>(depth)))));
+}
+
+/**
+ * @brief Compacts every full level: it is sorted and every other item is promoted to the level above.
+ *
+ * The kept half alternates between odd and even positions on successive compactions, which keeps
+ * the sketch deterministic while cancelling the rank bias a fixed choice would introduce.
+ */
+void QuantileSketch::Compress()
+{
+    for (size_t h = 0; h < levels.size(); h++)
+    {
+        if (levels[h].size() < Capacity(h))
+            continue;
+        if (h + 1 == levels.size())
+            levels.emplace_back();
+
+        auto &level = levels[h];
+        sort(level.begin(), level.end());
+        size_t offset = compactions++ & 1;
+        // An odd item out stays behind at this level
+        size_t paired = level.size() & ~size_t(1);
+        for (size_t i = offset; i < paired; i += 2)
+        {
+            levels[h + 1].push_back(level[i]);
+        }
+        if (paired < level.size())
+            level[0] = level.back();
+        level.resize(level.size() - paired);
+    }
+}
+
+/**
+ * @brief Writes the sketch, level by level, to a checkpoint.
+ * @param out The checkpoint being written.
+ */
+void QuantileSketch::SaveCheckpoint(CheckpointWriter &out) const
+{
+    out.Write<int32_t>(k);
+    out.Write<uint64_t>(count);
+    out.Write<uint32_t>(compactions);
+    out.Write<uint64_t>(levels.size());
+    for (const auto &level : levels)
+        out.WriteArray(level);
+}
+
+/**
+ * @brief Replaces the sketch with one read from a checkpoint.
+ * @param in The checkpoint being read.
+ */
+void QuantileSketch::RestoreCheckpoint(CheckpointReader &in)
+{
+    k = in.Read<int32_t>();
+    count = static_cast<size_t>(in.Read<uint64_t>());
+    compactions = in.Read<uint32_t>();
+    levels.resize(static_cast<size_t>(in.Read<uint64_t>()));
+    for (auto &level : levels)
+        in.ReadArray(level);
+}
+
+/**
+ * @brief Constructs an empty aggregate.
+ */
+StreamingStats::StreamingStats()
+    : count(0), sum(0.0), min(numeric_limits<double>::infinity()), max(-numeric_limits<double>::infinity()), mean(0.0), m2(0.0)
+{
+}
+
+/**
+ * @brief Folds a sample into the aggregate.
+ * @param value The sample.
+ */
+void StreamingStats::Add(double value)
+{
+    count++;
+    sum += value;
+    min = value < min ? value : min;
+    max = value > max ? value : max;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+    sketch.Add(value);
+}
+
+/**
+ * @brief Merges another aggregate into this one, combining the variances with Chan's parallel formula.
+ * @param other The aggregate to merge.
+ */
+void StreamingStats::Merge(const StreamingStats &other)
+{
+    if (other.count == 0)
+        return;
+    if (count == 0)
+    {
+        *this = other;
+        return;
+    }
+
+    size_t total = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / total);
+    count = total;
+    sum += other.sum;
+    min = other.min < min ? other.min : min;
+    max = other.max > max ? other.max : max;
+    sketch.Merge(other.sketch);
+}
+
+/**
+ * @brief Returns the number of samples folded in.
+ * @return size_t Sample count.
+ */
+size_t StreamingStats::GetCount() const
+{
+    return count;
+}
+
+/**
+ * @brief Returns the sum of the samples.
+ * @return double Sum, 0 if empty.
+ */
+double StreamingStats::GetSum() const
+{
+    return sum;
+}
+
+/**
+ * @brief Returns the smallest sample.
+ * @return double Minimum, 0 if empty.
+ */
+double StreamingStats::GetMin() const
+{
+    return count > 0 ? min : 0.0;
+}
+
+/**
+ * @brief Returns the largest sample.
+ * @return double Maximum, 0 if empty.
+ */
+double StreamingStats::GetMax() const
+{
+    return count > 0 ? max : 0.0;
+}
+
+/**
+ * @brief Returns the mean of the samples.
+ * @return double Mean, 0 if empty.
+ */
+double StreamingStats::GetMean() const
+{
+    return mean;
+}
+
+/**
+ * @brief Returns the sample variance.
+ * @return double Unbiased variance, 0 with fewer than two samples.
+ */
+double StreamingStats::GetVariance() const
+{
+    return count > 1 ? m2 / (count - 1) : 0.0;
+}
+
+/**
+ * @brief Estimates a percentile from the quantile sketch.
+ * @param q Rank between 0 and 1.
+ * @return double The estimated quantile.
+ */
+double StreamingStats::Quantile(double q) const
+{
+    return sketch.Quantile(q);
+}
+
+/**
+ * @brief Writes the aggregate to a checkpoint.
+ * @param out The checkpoint being written.
+ */
+void StreamingStats::SaveCheckpoint(CheckpointWriter &out) const
+{
+    out.Write<uint64_t>(count);
+    out.Write(sum);
+    out.Write(min);
+    out.Write(max);
+    out.Write(mean);
+    out.Write(m2);
+    sketch.SaveCheckpoint(out);
+}
+
+/**
+ * @brief Replaces the aggregate with one read from a checkpoint.
+ * @param in The checkpoint being read.
+ */
+void StreamingStats::RestoreCheckpoint(CheckpointReader &in)
+{
+    count = static_cast<size_t>(in.Read<uint64_t>());
+    sum = in.Read<double>();
+    min = in.Read<double>();
+    max = in.Read<double>();
+    mean = in.Read<double>();
+    m2 = in.Read<double>();
+    sketch.RestoreCheckpoint(in);
+}
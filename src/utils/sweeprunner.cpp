@@ -0,0 +1,222 @@
+/**
+ * @file sweeprunner.cpp
+ * @brief Implementation of SweepRunner, a parameter sweep over fleet size, station count and horizon.
+ *
+ * The grid is the cartesian product of the miner, station and horizon values. Every configuration
+ * is an unpaced Simulation in the same process, scheduled across a worker pool one configuration
+ * per chunk, so a large grid costs neither a process launch nor a paced run per point. Every
+ * configuration runs with the same seed, the differences between rows come from the
+ * configuration and not from the random streams.
+ */
+
+#include "../inlcude/utils/sweeprunner.h"
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace std;
+
+/**
+ * @brief Constructs a sweep.
+ * @param miners Miner counts of the grid.
+ * @param stations Station counts of the grid.
+ * @param horizons Horizons of the grid, in ticks.
+ * @param seed Seed every configuration runs with.
+ * @param workers Configurations run at once, 0 sizes the pool to the hardware.
+ */
+SweepRunner::SweepRunner(const vector<int> &miners, const vector<int> &stations, const vector<int> &horizons,
+                         uint64_t seed, unsigned int workers)
+    : miners(miners), stations(stations), horizons(horizons), seed(seed), workers(workers), engine(TickHandler::TICK)
+{
+}
+
+/**
+ * @brief Selects the engine every configuration runs with.
+ * @param engine One of TickHandler::ENGINE.
+ */
+void SweepRunner::SetEngine(int engine)
+{
+    this->engine = engine;
+}
+
+/**
+ * @brief Runs every configuration of the grid.
+ */
+void SweepRunner::Run()
+{
+    size_t perMiners = stations.size() * horizons.size();
+    results.assign(miners.size() * perMiners, {});
+    WorkerPool pool(workers);
+    pool.parallelFor(0, static_cast<int>(results.size()), 1, [&](int begin, int end, unsigned int)
+                     {
+                         for (int i = begin; i < end; i++)
+                         {
+                             size_t index = static_cast<size_t>(i);
+                             results[index] = runConfiguration(miners[index / perMiners],
+                                                               stations[index / horizons.size() % stations.size()],
+                                                               horizons[index % horizons.size()]);
+                         }
+                     });
+}
+
+/**
+ * @brief Runs one configuration on the calling thread and reduces it to its key outcomes.
+ * @param miners Number of miners.
+ * @param stations Number of stations.
+ * @param horizon Horizon in ticks.
+ * @return Result The configuration's outcomes, or why it failed, a failure does not end the sweep.
+ */
+SweepRunner::Result SweepRunner::runConfiguration(int miners, int stations, int horizon) const
+{
+    Result result{};
+    result.miners = miners;
+    result.stations = stations;
+    result.horizon = horizon;
+    map<string, StreamingStats> aggregates;
+    try
+    {
+        Simulation simulation(miners, stations, seed);
+        simulation.SetEngine(engine);
+        simulation.SetHorizon(horizon);
+        simulation.Run();
+        aggregates = simulation.GetMetrics().GetAggregatesByMetric();
+    }
+    catch (const exception &e)
+    {
+        result.error = e.what();
+        return result;
+    }
+
+    const StreamingStats &queue = aggregates["QueueTimes"];
+    // Every unload records one UtilizationRate sample
+    result.unloads = aggregates["UtilizationRate"].GetCount();
+    // 12 five-minute ticks per hour
+    result.unloadsPerHour = horizon > 0 ? result.unloads * 12.0 / horizon : 0.0;
+    result.materialVolume = aggregates["MaterialVolume"].GetSum();
+    result.avgQueue = queue.GetMean();
+    result.p90Queue = queue.GetCount() > 0 ? queue.Quantile(0.9) : 0.0;
+    result.maxQueue = queue.GetCount() > 0 ? queue.GetMax() : 0.0;
+    // A station unloads at most once per tick
+    result.stationUtilization = stations > 0 && horizon > 0 ? static_cast<double>(result.unloads) / (static_cast<double>(stations) * horizon) : 0.0;
+    return result;
+}
+
+/**
+ * @brief Returns the results of the last Run.
+ * @return const vector<Result>& One result per configuration, miners-major.
+ */
+const vector<SweepRunner::Result> &SweepRunner::GetResults() const
+{
+    return results;
+}
+
+/**
+ * @brief Parses a list or range of values.
+ * Accepts a single value "50", a list "10,20,40" or an inclusive range "10:100" or "10:100:10" with a step.
+ * @param spec The specification.
+ * @return vector<int> The values, in the given order.
+ */
+vector<int> SweepRunner::ParseRange(const string &spec)
+{
+    auto parse = [&spec](const string &text)
+    {
+        size_t used = 0;
+        int value = 0;
+        try
+        {
+            value = stoi(text, &used);
+        }
+        catch (const exception &)
+        {
+            used = 0;
+        }
+        if (used == 0 || used != text.size())
+            throw invalid_argument("Invalid range: " + spec);
+        return value;
+    };
+
+    vector<int> values;
+    size_t colon = spec.find(':');
+    if (colon == string::npos)
+    {
+        size_t begin = 0;
+        while (true)
+        {
+            size_t comma = spec.find(',', begin);
+            values.push_back(parse(spec.substr(begin, comma - begin)));
+            if (comma == string::npos)
+                break;
+            begin = comma + 1;
+        }
+        return values;
+    }
+
+    size_t second = spec.find(':', colon + 1);
+    int first = parse(spec.substr(0, colon));
+    int last = parse(spec.substr(colon + 1, second == string::npos ? string::npos : second - colon - 1));
+    int step = second == string::npos ? 1 : parse(spec.substr(second + 1));
+    if (step <= 0 || last < first)
+        throw invalid_argument("Invalid range: " + spec);
+    for (long long value = first; value <= last; value += step)
+        values.push_back(static_cast<int>(value));
+    return values;
+}
+
+/**
+ * @brief Lists the results as a table, formatted for console output.
+ */
+void SweepRunner::ListResults() const
+{
+    cout << "Sweep: " << results.size() << " configurations (seed " << seed << ")" << endl;
+    cout << setw(8) << "Miners" << setw(10) << "Stations" << setw(9) << "Horizon"
+         << setw(9) << "Unloads" << setw(12) << "Unloads/h" << setw(11) << "AvgQueue"
+         << setw(10) << "P90Queue" << setw(10) << "MaxQueue" << setw(13) << "Utilization" << endl;
+    cout << fixed << setprecision(3);
+    for (const auto &result : results)
+    {
+        cout << setw(8) << result.miners << setw(10) << result.stations << setw(9) << result.horizon;
+        if (!result.error.empty())
+        {
+            cout << "  Failed: " << result.error << endl;
+            continue;
+        }
+        cout << setw(9) << result.unloads << setw(12) << result.unloadsPerHour << setw(11) << result.avgQueue
+             << setw(10) << result.p90Queue << setw(10) << result.maxQueue << setw(13) << result.stationUtilization << endl;
+    }
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
+
+/**
+ * @brief Exports the results to a csv file, one row per configuration, timestamped like the metrics export.
+ * @param filename The filename.
+ */
+void SweepRunner::SaveResultsToCsv(const string &filename) const
+{
+    string relativePath = MetricsHandler::TimestampedPath(filename);
+    ofstream out(relativePath);
+    if (!out.is_open())
+    {
+        cout << "Unable to open file: " << relativePath << endl;
+        return;
+    }
+
+    out << "Miners,Stations,Horizon,Unloads,UnloadsPerHour,MaterialVolume,AvgQueue,P90Queue,MaxQueue,StationUtilization,Error\n";
+    out << setprecision(17);
+    for (const auto &result : results)
+    {
+        out << result.miners << ',' << result.stations << ',' << result.horizon << ','
+            << result.unloads << ',' << result.unloadsPerHour << ',' << result.materialVolume << ','
+            << result.avgQueue << ',' << result.p90Queue << ',' << result.maxQueue << ','
+            << result.stationUtilization << ',';
+        // Quoted so a message with commas stays one field
+        if (!result.error.empty())
+            out << '"' << result.error << '"';
+        out << '\n';
+    }
+
+    if (out.flush())
+        cout << "Sweep results saved to " << relativePath << endl;
+    else
+        cout << "Unable to write file: " << relativePath << endl;
+}
@@ -3,173 +3,925 @@
  * @brief TickHandler class manages timed events for miners and stations in the simulation.
  *
  * This class is responsible for managing the lifecycle of miners within the simulation,
- * including their creation, state updates, and interactions with stations. It uses a
- * multi-threaded approach to simulate concurrent actions of different miners.
+ * including their creation, state updates, and interactions with stations. A single timer
+ * thread advances simulated time and fans every tick out across a fixed-size work-stealing
+ * pool, so the thread count follows the hardware rather than the fleet size.
+ *
+ * An alternative event engine skips idle ticks: each miner's next transition is scheduled
+ * on a timing wheel and only miners whose events fire are touched, so runtime follows the
+ * number of state changes rather than miners times ticks.
+ *
+ * The lockstep engine splits every tick into phases separated by barriers: miners decide in
+ * parallel against the station state frozen at the start of the tick, the station updates they
+ * request are committed in miner ID order, then their transitions run in parallel. No phase
+ * depends on how miners were dealt to workers, so a run gives the same results at any worker count.
  */
 
 #include "../inlcude/utils/tickhandler.h"
 
 using namespace std;
 
+namespace
+{
+    // Indexed by TickHandler::METRIC
+    const char *const METRIC_NAMES[] = {"DistanceTraveled", "LoadCapacityUtilized", "FuelConsumption", "MiningTime",
+                                        "QueueTimes", "MaterialVolume", "MaterialQuality", "UtilizationRate"};
+}
+
+/**
+ * @brief Returns the name a metric is recorded under.
+ * @param metric One of TickHandler::METRIC.
+ * @return const char* Metric name.
+ */
+const char *TickHandler::GetMetricName(int metric)
+{
+    return METRIC_NAMES[metric];
+}
+
 /**
  * @brief Constructs a TickHandler with references to the miner and station managers and sets the tick interval.
  * @param minerManager Reference to the miner manager.
  * @param stationManager Reference to the station manager.
- * @param interval_ms Tick interval in milliseconds.
+ * @param interval_ms Tick interval in milliseconds. An interval of 0 runs unpaced, as fast as the CPU allows.
+ * @param workers Number of pool workers processing miners. 0 sizes the pool to the hardware.
+ * @param metricsHandler Handler the run's metrics are recorded into.
  */
-TickHandler::TickHandler(MinerManager &minerManager, StationManager &stationManager, unsigned int interval_ms)
-    : minerManager(minerManager), stationManager(stationManager), interval_ms_(interval_ms), keepRunning_(false)
+TickHandler::TickHandler(MinerManager &minerManager, StationManager &stationManager, unsigned int interval_ms, unsigned int workers, MetricsHandler &metricsHandler)
+    : minerManager(minerManager), stationManager(stationManager), metricsHandler(metricsHandler), interval_ms_(interval_ms), pool_(workers), keepRunning_(false), running_(false), engine_(TICK), horizon_(MAX_TICK), currentTick_(0), nextTick_(0), checkpointTick_(-1), live_(nullptr), log_(nullptr), flusher_(nullptr)
 {
+    registerMetrics();
+
+    uint64_t seed = minerManager.GetSeed();
+    for (int id = 0; id < minerManager.GetAssets(); id++)
+    {
+        minerStreams_.emplace_back(seed, RandomStream::Entity(RandomStream::MINER_METRICS, id));
+    }
+    for (int id = 0; id < stationManager.GetAssets(); id++)
+    {
+        stationStreams_.emplace_back(seed, RandomStream::Entity(RandomStream::STATION_METRICS, id));
+    }
 }
 
 /**
- * @brief Starts the simulation by launching threads for each mine.
+ * @brief Starts the simulation by launching the timer thread that drives the worker pool.
  */
 void TickHandler::start()
 {
     keepRunning_ = true;
-    for (int i = 0; i < minerManager.GetAssets(); i++)
+    running_ = true;
+    failure_ = nullptr;
+    timerThread_ = thread([this]()
+                          {
+                              // Handed to the thread that waits for the run instead of terminating the process
+                              try
+                              {
+                                  this->run();
+                              }
+                              catch (...)
+                              {
+                                  failure_ = current_exception();
+                                  running_ = false;
+                              } });
+}
+
+/**
+ * @brief Stops the simulation and joins the timer thread to ensure clean shutdown.
+ */
+void TickHandler::stop()
+{
+    keepRunning_ = false;
+    wait();
+}
+
+/**
+ * @brief Blocks until the simulation has reached the horizon or been stopped, then joins the timer thread.
+ * @throws Whatever the run threw on the timer thread, once it has ended.
+ */
+void TickHandler::wait()
+{
+    if (timerThread_.joinable())
+    {
+        timerThread_.join();
+    }
+    if (failure_)
     {
-        timerThreads_.emplace_back([this, i]()
-                                   { this->tick(i); });
+        exception_ptr failure = failure_;
+        failure_ = nullptr;
+        rethrow_exception(failure);
     }
 }
 
 /**
- * @brief Stops the simulation and joins all miner threads to ensure clean shutdown.
+ * @brief Checks whether the simulation is still advancing.
+ * @return true While the horizon has not been reached and stop() has not been called.
  */
-void TickHandler::stop()
+bool TickHandler::isRunning() const
+{
+    return keepRunning_ && running_;
+}
+
+/**
+ * @brief Selects the engine used by the next start(), also after RestoreCheckpoint has restored the checkpoint's engine.
+ * @param engine One of TickHandler::ENGINE.
+ */
+void TickHandler::SetEngine(int engine)
+{
+    // Leaving the event engine, the miners take over their countdowns and the schedule is rebuilt if it is picked again
+    if (engine_ == EVENT && engine != EVENT)
+    {
+        catchUp();
+        scheduled_.clear();
+        wheel_.clear();
+    }
+    engine_ = engine;
+}
+
+/**
+ * @brief Sets the number of ticks the next start() simulates.
+ * @param ticks Horizon in ticks, MAX_TICK by default.
+ */
+void TickHandler::SetHorizon(int ticks)
+{
+    horizon_ = ticks;
+}
+
+/**
+ * @brief Returns the number of ticks a run simulates.
+ * @return int Horizon in ticks.
+ */
+int TickHandler::GetHorizon() const
+{
+    return horizon_;
+}
+
+/**
+ * @brief Switches per-phase tick profiling on or off for the next start(). A new profile is started when switched on.
+ * @param enabled True to profile.
+ */
+void TickHandler::EnableProfiling(bool enabled)
+{
+    profiler_ = enabled ? make_unique<TickProfiler>(pool_.GetWorkers()) : nullptr;
+}
+
+/**
+ * @brief Returns the profile of the run, if profiling is on.
+ * @return TickProfiler* The profiler, or nullptr.
+ */
+TickProfiler *TickHandler::GetProfiler() const
+{
+    return profiler_.get();
+}
+
+/**
+ * @brief Attaches counters that are kept up to date while the simulation runs, for a metrics server to expose.
+ * @param liveMetrics The counters, sized for the run's stations, or nullptr to detach them. They must outlive the run.
+ */
+void TickHandler::SetLiveMetrics(LiveMetrics *liveMetrics)
+{
+    live_ = liveMetrics;
+}
+
+/**
+ * @brief Attaches an event log. While attached, the run records events into it in place of metric samples.
+ * @param eventLog The log, with an arena for every worker, or nullptr to record metric samples. It must outlive the run.
+ * @throws std::invalid_argument if the log has fewer arenas than the pool has workers.
+ */
+void TickHandler::SetEventLog(EventLog *eventLog)
+{
+    if (eventLog && eventLog->GetArenas() < pool_.GetWorkers())
+        throw invalid_argument("The event log needs an arena per worker");
+    log_ = eventLog;
+}
+
+/**
+ * @brief Attaches a flusher that writes samples out in the background while the run goes on.
+ * @param metricsFlusher The flusher, or nullptr to keep every sample until the end. Must outlive the run.
+ */
+void TickHandler::SetMetricsFlusher(MetricsFlusher *metricsFlusher)
+{
+    flusher_ = metricsFlusher;
+}
+
+/**
+ * @brief Returns the number of pool workers processing miners, including the timer thread.
+ * @return unsigned int Worker count.
+ */
+unsigned int TickHandler::GetWorkers() const
+{
+    return pool_.GetWorkers();
+}
+
+/**
+ * @brief Returns the next tick to be simulated.
+ * @return int Ticks simulated so far, including those before a restored checkpoint.
+ */
+int TickHandler::GetTick() const
 {
+    return nextTick_;
+}
+
+/**
+ * @brief Saves a checkpoint once the run has simulated a given number of ticks, then carries on.
+ * @param tick Ticks simulated when the checkpoint is taken, up to the horizon.
+ * @param path Path of the checkpoint file.
+ */
+void TickHandler::SetCheckpoint(int tick, const string &path)
+{
+    checkpointTick_ = tick;
+    checkpointPath_ = path;
+}
+
+/**
+ * @brief Writes the complete simulation state to a checkpoint file.
+ *
+ * Covers the fleet, the station queues, the tick counter, every random stream, the event
+ * schedule and the metrics recorded so far. Only call between ticks or while not running.
+ *
+ * @param path Path of the checkpoint file.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void TickHandler::SaveCheckpoint(const string &path)
+{
+    CheckpointWriter out(path);
+    minerManager.SaveCheckpoint(out);
+    stationManager.SaveCheckpoint(out);
+
+    out.Write<int32_t>(nextTick_);
+    out.Write<int32_t>(engine_);
+    vector<uint64_t> counters;
+    for (const auto &stream : minerStreams_)
+        counters.push_back(stream.GetCounter());
+    out.WriteArray(counters);
+    counters.clear();
+    for (const auto &stream : stationStreams_)
+        counters.push_back(stream.GetCounter());
+    out.WriteArray(counters);
+    out.WriteArray(scheduled_);
+
+    metricsHandler.SaveCheckpoint(out);
+    out.Close();
+}
+
+/**
+ * @brief Replaces the simulation state with a checkpoint, the next start() resumes from its tick.
+ * The checkpoint's engine is restored too, a later SetEngine switches it.
+ * @param path Path of the checkpoint file.
+ * @throws std::runtime_error if the file is not a checkpoint or does not match the fleet and station counts.
+ */
+void TickHandler::RestoreCheckpoint(const string &path)
+{
+    CheckpointReader in(path);
+    minerManager.RestoreCheckpoint(in);
+    stationManager.RestoreCheckpoint(in);
+
+    nextTick_ = in.Read<int32_t>();
+    engine_ = in.Read<int32_t>();
+    uint64_t seed = minerManager.GetSeed();
+    vector<uint64_t> counters;
+    in.ReadArray(counters);
+    if (counters.size() != minerStreams_.size())
+        throw runtime_error("Corrupt checkpoint");
+    for (size_t id = 0; id < counters.size(); id++)
+        minerStreams_[id] = RandomStream(seed, RandomStream::Entity(RandomStream::MINER_METRICS, static_cast<int>(id)), counters[id]);
+    in.ReadArray(counters);
+    if (counters.size() != stationStreams_.size())
+        throw runtime_error("Corrupt checkpoint");
+    for (size_t id = 0; id < counters.size(); id++)
+        stationStreams_[id] = RandomStream(seed, RandomStream::Entity(RandomStream::STATION_METRICS, static_cast<int>(id)), counters[id]);
+
+    // Only the live entry of each miner is put back on the wheel, stale entries were never needed
+    in.ReadArray(scheduled_);
+    wheel_.clear();
+    for (size_t id = 0; id < scheduled_.size(); id++)
+    {
+        if (scheduled_[id] >= 0)
+            wheel_.schedule(scheduled_[id], static_cast<int>(id));
+    }
+
+    metricsHandler.RestoreCheckpoint(in);
+    if (!in.AtEnd())
+        throw runtime_error("Corrupt checkpoint");
+    registerMetrics();
+}
+
+/**
+ * @brief Resolves the metric and asset IDs used for recording, registering the names on first use.
+ * Asset and metric names are resolved once, so recording never builds or compares strings.
+ */
+void TickHandler::registerMetrics()
+{
+    for (int metric = 0; metric < METRIC_COUNT; metric++)
+    {
+        metricIds_[metric] = metricsHandler.RegisterMetric(METRIC_NAMES[metric]);
+    }
+    minerAssets_.clear();
+    stationAssets_.clear();
+    for (int id = 0; id < minerManager.GetAssets(); id++)
+    {
+        minerAssets_.push_back(metricsHandler.RegisterAsset("Miner-" + to_string(id + 1)));
+    }
+    for (int id = 0; id < stationManager.GetAssets(); id++)
+    {
+        stationAssets_.push_back(metricsHandler.RegisterAsset("Station-" + to_string(id + 1)));
+    }
+}
+
+/**
+ * @brief Destructor that ensures the timer thread is stopped.
+ */
+TickHandler::~TickHandler()
+{
+    // A failed run is only reported by wait(), the destructor just joins
     keepRunning_ = false;
-    for (auto &thread : timerThreads_)
+    if (timerThread_.joinable())
+    {
+        timerThread_.join();
+    }
+}
+
+/**
+ * @brief Advances the whole fleet one tick at a time, fanning each tick out across the worker pool.
+ *
+ * Miners are split into chunks, several per worker, so that workers whose miners are busy with
+ * station lookups (SEARCHING, WAITING) can have their remaining chunks stolen by idle workers.
+ */
+void TickHandler::run()
+{
+    int assets = minerManager.GetAssets();
+    int grain = max(1, assets / static_cast<int>(pool_.GetWorkers() * 8));
+    //The horizon defaults to 864 ticks since each tick is 5 minutes and we want to simulate a run of 72 hours
+    // Unpaced (batch) runs never sleep, so they skip reading the clock altogether unless profiled
+    bool paced = interval_ms_ > 0;
+    TickProfiler *profiler = profiler_.get();
+    bool timed = paced || profiler;
+    int firstTick = nextTick_;
+    auto runStart = chrono::steady_clock::now();
+    if (live_)
     {
-        if (thread.joinable())
+        live_->Begin(nextTick_);
+        live_->Publish(minerManager.GetStates(), assets, stationManager);
+    }
+
+    // The event engine starts by scheduling every miner's next transition, unless a restored schedule is in place
+    if (engine_ == EVENT && scheduled_.size() != static_cast<size_t>(assets))
+    {
+        wheel_.clear();
+        scheduled_.assign(assets, -1);
+        const int *states = minerManager.GetStates();
+        for (int id = 0; id < assets; id++)
         {
-            thread.join();
+            bool counting = states[id] == Miner::MINING || states[id] == Miner::RETURN;
+            schedule(id, nextTick_ + (counting ? minerManager.GetMiner(id).GetTime() : 0));
         }
     }
-    timerThreads_.clear();
+
+    requests_.resize((assets + grain - 1) / grain);
+    if (log_)
+        logBegin();
+
+    while (keepRunning_ && nextTick_ < horizon_)
+    {
+        if (nextTick_ == checkpointTick_)
+            checkpoint();
+
+        chrono::steady_clock::time_point start;
+        if (timed)
+            start = chrono::steady_clock::now();
+
+        // Published to the workers by the pool hand-off, metrics are tagged with it
+        currentTick_ = nextTick_;
+        if (engine_ == EVENT)
+            tickEvents(nextTick_);
+        else if (engine_ == LOCKSTEP)
+            tickLockstep(assets, grain);
+        else
+            pool_.parallelFor(0, assets, grain, [this, grain](int begin, int end, unsigned int worker)
+                              { this->tick(begin, end, worker, requests_[begin / grain]); });
+        // No worker records between ticks, the arenas are written out and reused
+        if (log_)
+            log_->Flush();
+        // Hourly, the samples recorded so far are rolled up and those outside the raw window dropped
+        if ((nextTick_ + 1) % ROLLUP_HOUR_TICKS == 0)
+            metricsHandler.Compact();
+        if (flusher_ && (nextTick_ + 1) % flusher_->GetInterval() == 0)
+            flusher_->Flush();
+
+        chrono::steady_clock::time_point end;
+        if (timed)
+            end = chrono::steady_clock::now();
+        if (profiler)
+            profiler->RecordTick(nextTick_, start, end, runStart + chrono::milliseconds(interval_ms_) * (nextTick_ - firstTick), interval_ms_);
+
+        if (paced)
+        {
+            auto elapsed = chrono::duration_cast<chrono::milliseconds>(end - start);
+            auto timeToWait = interval_ms_ - elapsed.count();
+            if (timeToWait > 0)
+            {
+                this_thread::sleep_for(chrono::milliseconds(timeToWait));
+                if (profiler)
+                    profiler->Record(0, TickProfiler::SLEEP, nextTick_, end, chrono::steady_clock::now());
+            }
+        }
+        nextTick_++;
+
+        // A scrape reads the counters at any time, the fleet snapshot is only refreshed between ticks after a scrape asked for it
+        if (live_)
+        {
+            live_->SetTick(nextTick_);
+            if (live_->SnapshotRequested())
+                live_->Publish(minerManager.GetStates(), assets, stationManager);
+        }
+    }
+    if (live_)
+        live_->Publish(minerManager.GetStates(), assets, stationManager);
+    catchUp();
+    // A checkpoint at the horizon holds the finished run
+    if (nextTick_ == checkpointTick_)
+        checkpoint();
+    if (flusher_)
+        flusher_->Flush();
+    running_ = false;
 }
 
 /**
- * @brief Destructor that ensures all miner threads are stopped.
+ * @brief Saves the checkpoint requested with SetCheckpoint from the timer thread, a failure does not end the run.
  */
-TickHandler::~TickHandler()
+void TickHandler::checkpoint()
 {
-    stop();
+    catchUp();
+    // The checkpoint does not hold samples waiting to be drained, they are written to the flush file first
+    if (flusher_)
+        flusher_->Sync();
+    try
+    {
+        SaveCheckpoint(checkpointPath_);
+        cout << "Checkpoint at tick " << nextTick_ << " saved to " << checkpointPath_ << endl;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+    }
 }
 
 /**
- * @brief Manages the tick events for a single miner, handling their state transitions and actions.
- * @param id Unique identifier of the miner to be processed.
+ * @brief Handles one tick for a block of miners: their station interactions followed by their state transitions.
+ * @param begin ID of the first miner in the block.
+ * @param end One past the ID of the last miner in the block.
+ * @param worker Index of the pool worker handling the block.
+ * @param unloaded Receives the IDs of the block's miners that finish unloading, while an event log is attached.
  */
-void TickHandler::tick(int id)
+void TickHandler::tick(int begin, int end, unsigned int worker, vector<int> &unloaded)
 {
-    Miner miner = minerManager.GetMiner(id);
-    int tickCount = 0;
-    //The max tick is set 864 since each tick is 5 minutes and we want to simulate a run of 72 hours
-    while (keepRunning_ && tickCount < MAX_TICK)
+    const int *states = minerManager.GetStates();
+    TickProfiler *profiler = profiler_.get();
+    chrono::steady_clock::time_point stationsStart;
+    if (profiler)
     {
-        auto start = chrono::steady_clock::now();
+        stationsStart = chrono::steady_clock::now();
+        TickProfiler::metricsTime = 0;
+    }
 
+    for (int id = begin; id < end; id++)
+    {
         // This is where the miner and station logic meets
         // A miner's state dictates what needs to be done with a station
-        switch(miner.GetState())
+        switch(states[id])
         {
             // In a searching state, after finding the shortest wait time at a queue, it either heads directly to the station to unload
             // or it enters a waiting state until the station is open for them
             case Miner::SEARCHING:
-            {
-                auto targetStation = stationManager.GetStation(stationManager.AddToShortestQueue(id));
-
-                if (targetStation && targetStation->isEmpty())
-                    miner.SetQueueStatus(Miner::FRONT);
-                else
-                    miner.SetQueueStatus(Miner::QUEUED);
-                miner.SetStation(targetStation->GetID());
+                enqueue(id, worker);
                 break;
-            }
             // A miner is waiting unitil its first in the queue to unload
             case Miner::WAITING:
             {
-                auto station = stationManager.GetStation(miner.GetStationID());
+                auto station = stationManager.GetStation(minerManager.GetStationID(id));
 
                 if (station && station->isFront(id))
-                    miner.SetQueueStatus(Miner::READY);
+                {
+                    minerManager.SetQueueStatus(id, Miner::READY);
+                    if (log_)
+                        log_->Record(worker, {currentTick_, id, station->GetID(), EventLog::FRONT, 0, static_cast<int32_t>(station->size()), 0.0});
+                }
                 break;
             }
             // While unloading, the miner also submits it status data at this point so we recieve metrics
             case Miner::UNLOADING:
             {
-                if(miner.GetQueueStatus() == Miner::COMPLETE)
+                if(minerManager.GetQueueStatus(id) == Miner::COMPLETE)
                 {
-                    int sID = miner.GetStationID();
-                    auto station = stationManager.GetStation(sID);
-
+                    Miner miner = minerManager.GetMiner(id);
                     MinierMetrics(miner, id);
-                    StationMetrics(*station, sID, miner.GetLoad());
-                    stationManager.PopStationQueue(sID);
+                    dequeue(id, miner, worker);
+                    if (log_)
+                        unloaded.push_back(id);
                 }
                 break;
             }
         }
+    }
+
+    chrono::steady_clock::time_point minersStart;
+    if (profiler)
+        minersStart = chrono::steady_clock::now();
+
+    //Handles the logic for the minners after station needs are established, countdowns run as one batch
+    minerManager.TickBlock(begin, end);
+    if (log_)
+    {
+        for (int id : unloaded)
+            logMiningStart(id, worker);
+        unloaded.clear();
+    }
+
+    if (profiler)
+    {
+        profiler->Record(worker, TickProfiler::STATIONS, currentTick_, stationsStart, minersStart, TickProfiler::metricsTime);
+        profiler->Record(worker, TickProfiler::MINERS, currentTick_, minersStart, chrono::steady_clock::now());
+    }
+}
+
+/**
+ * @brief Handles one tick of the event engine, touching only the miners whose events fire on it.
+ *
+ * Due miners first read station state, then the station updates they requested are committed in
+ * miner ID order, then their transitions run. A miner idle in MINING or RETURN skipped its countdown
+ * ticks, so its time is caught up to zero before its transition. Removals become visible to waiting
+ * miners on the next tick, when the new front of the queue is signalled directly.
+ *
+ * @param tick Current tick.
+ */
+void TickHandler::tickEvents(int tick)
+{
+    due_.clear();
+    wheel_.popDue(tick, due_);
+
+    // Entries superseded by an earlier signal are stale
+    size_t live = 0;
+    for (int id : due_)
+    {
+        if (scheduled_[id] == tick)
+        {
+            scheduled_[id] = -1;
+            due_[live++] = id;
+        }
+    }
+    due_.resize(live);
 
-        int ticksRemaining = MAX_TICK - tickCount;
-        
-        //Handles the logic for the minner after station needs are established
+    // The event engine runs on the timer thread, worker 0
+    TickProfiler *profiler = profiler_.get();
+    chrono::steady_clock::time_point stationsStart;
+    if (profiler)
+    {
+        stationsStart = chrono::steady_clock::now();
+        TickProfiler::metricsTime = 0;
+    }
+
+    commits_.clear();
+    for (int id : due_)
+        decide(id, commits_, 0);
+    for (int id : commits_)
+        commit(id, tick);
+
+    chrono::steady_clock::time_point minersStart;
+    if (profiler)
+        minersStart = chrono::steady_clock::now();
+
+    for (int id : due_)
+    {
+        Miner miner = minerManager.GetMiner(id);
+        int previous = miner.GetState();
+        if (previous == Miner::MINING || previous == Miner::RETURN)
+            miner.SetTime(0);
         miner.tick();
+        minerManager.SetMiner(id, miner);
+        if (log_ && previous == Miner::UNLOADING && miner.GetState() == Miner::MINING)
+            logMiningStart(id, 0);
+
+        switch (miner.GetState())
+        {
+            case Miner::MINING:
+            case Miner::RETURN:
+                schedule(id, tick + 1 + miner.GetTime());
+                break;
+            // A waiting miner that is not at the front sleeps until a removal signals it
+            case Miner::WAITING:
+                if (previous != Miner::WAITING)
+                    schedule(id, tick + 1);
+                break;
+            default:
+                schedule(id, tick + 1);
+                break;
+        }
+    }
+
+    if (profiler)
+    {
+        profiler->Record(0, TickProfiler::STATIONS, tick, stationsStart, minersStart, TickProfiler::metricsTime);
+        profiler->Record(0, TickProfiler::MINERS, tick, minersStart, chrono::steady_clock::now());
+    }
+}
 
-        auto end = chrono::steady_clock::now();
-        auto elapsed = chrono::duration_cast<chrono::milliseconds>(end - start);
-        auto timeToWait = interval_ms_ - elapsed.count();
-        if (timeToWait > 0)
+/**
+ * @brief Brings the countdowns of miners idle in MINING or RETURN up to the next tick, as the tick engine would
+ * have counted them. The event engine only catches a countdown up when the miner wakes, so this runs before its
+ * state is saved or read after a run. A no-op for the other engines.
+ */
+void TickHandler::catchUp()
+{
+    if (engine_ != EVENT || scheduled_.size() != static_cast<size_t>(minerManager.GetAssets()))
+        return;
+    const int *states = minerManager.GetStates();
+    for (int id = 0; id < minerManager.GetAssets(); id++)
+    {
+        if ((states[id] == Miner::MINING || states[id] == Miner::RETURN) && scheduled_[id] >= 0)
         {
-            this_thread::sleep_for(chrono::milliseconds(timeToWait));
+            // Woken on tick w, the miner's countdown reaches zero on tick w - 1
+            Miner miner = minerManager.GetMiner(id);
+            miner.SetTime(max(0, scheduled_[id] - nextTick_));
+            minerManager.SetMiner(id, miner);
         }
-        tickCount++;
     }
 }
 
 /**
- * @brief Records performance metrics for a miner.
+ * @brief Handles one tick of the lockstep engine as a decide, a commit and a transition phase.
+ *
+ * Each parallelFor only returns once every chunk is done, which is the barrier between phases.
+ * While miners decide, stations are only read, so every miner sees the queues as they were at the
+ * start of the tick. Chunks cover the fleet in ID order, so committing their requests chunk by
+ * chunk applies the station updates in miner ID order whichever worker handled each chunk.
+ *
+ * @param assets Number of miners.
+ * @param grain Miners per chunk.
+ */
+void TickHandler::tickLockstep(int assets, int grain)
+{
+    pool_.parallelFor(0, assets, grain, [this, grain](int begin, int end, unsigned int worker)
+                      { this->decideBlock(begin, end, worker, requests_[begin / grain]); });
+
+    // The commit phase runs on the timer thread, worker 0
+    TickProfiler *profiler = profiler_.get();
+    chrono::steady_clock::time_point commitStart;
+    if (profiler)
+    {
+        commitStart = chrono::steady_clock::now();
+        TickProfiler::metricsTime = 0;
+    }
+
+    const int *states = minerManager.GetStates();
+    for (const auto &requests : requests_)
+    {
+        for (int id : requests)
+        {
+            if (states[id] == Miner::SEARCHING)
+                enqueue(id, 0);
+            else
+                dequeue(id, minerManager.GetMiner(id), 0);
+        }
+    }
+
+    if (profiler)
+        profiler->Record(0, TickProfiler::STATIONS, currentTick_, commitStart, chrono::steady_clock::now(), TickProfiler::metricsTime);
+
+    pool_.parallelFor(0, assets, grain, [this, grain](int begin, int end, unsigned int worker)
+                      {
+                          chrono::steady_clock::time_point minersStart;
+                          if (profiler_)
+                              minersStart = chrono::steady_clock::now();
+                          minerManager.TickBlock(begin, end);
+                          // Of the chunk's requests, only miners that left a station start mining
+                          if (log_)
+                          {
+                              for (int id : requests_[begin / grain])
+                                  logMiningStart(id, worker);
+                          }
+                          if (profiler_)
+                              profiler_->Record(worker, TickProfiler::MINERS, currentTick_, minersStart, chrono::steady_clock::now()); });
+}
+
+/**
+ * @brief Runs the lockstep decide phase for a block of miners, noting the station updates they need.
+ * @param begin ID of the first miner in the block.
+ * @param end One past the ID of the last miner in the block.
+ * @param worker Index of the pool worker handling the block.
+ * @param requests Receives the IDs of miners that must enqueue or leave a station, in ID order.
+ */
+void TickHandler::decideBlock(int begin, int end, unsigned int worker, vector<int> &requests)
+{
+    TickProfiler *profiler = profiler_.get();
+    chrono::steady_clock::time_point decideStart;
+    if (profiler)
+    {
+        decideStart = chrono::steady_clock::now();
+        TickProfiler::metricsTime = 0;
+    }
+
+    requests.clear();
+    for (int id = begin; id < end; id++)
+        decide(id, requests, worker);
+
+    if (profiler)
+        profiler->Record(worker, TickProfiler::STATIONS, currentTick_, decideStart, chrono::steady_clock::now(), TickProfiler::metricsTime);
+}
+
+/**
+ * @brief Schedules a miner's next visit by the event engine, replacing any later visit.
+ * @param id Unique identifier of the miner.
+ * @param tick Tick of the visit.
+ */
+void TickHandler::schedule(int id, int tick)
+{
+    if (scheduled_[id] == tick)
+        return;
+    scheduled_[id] = tick;
+    wheel_.schedule(tick, id);
+}
+
+/**
+ * @brief Reads the station state a due miner depends on and notes the station updates it needs.
+ * @param id Unique identifier of the miner.
+ * @param commits Receives the IDs of miners that must enqueue or leave a station.
+ * @param worker Index of the pool worker handling the miner.
+ */
+void TickHandler::decide(int id, vector<int> &commits, unsigned int worker)
+{
+    switch (minerManager.GetStates()[id])
+    {
+        case Miner::SEARCHING:
+            commits.push_back(id);
+            break;
+        case Miner::WAITING:
+        {
+            auto station = stationManager.GetStation(minerManager.GetStationID(id));
+
+            if (station && station->isFront(id))
+            {
+                minerManager.SetQueueStatus(id, Miner::READY);
+                if (log_)
+                    log_->Record(worker, {currentTick_, id, station->GetID(), EventLog::FRONT, 0, static_cast<int32_t>(station->size()), 0.0});
+            }
+            break;
+        }
+        case Miner::UNLOADING:
+        {
+            if (minerManager.GetQueueStatus(id) == Miner::COMPLETE)
+            {
+                Miner miner = minerManager.GetMiner(id);
+                MinierMetrics(miner, id);
+                commits.push_back(id);
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Applies a station update noted by decide() and signals a station's new front miner.
+ * @param id Unique identifier of the miner.
+ * @param tick Current tick.
+ */
+void TickHandler::commit(int id, int tick)
+{
+    if (minerManager.GetStates()[id] == Miner::SEARCHING)
+    {
+        enqueue(id, 0);
+        return;
+    }
+
+    int sID = dequeue(id, minerManager.GetMiner(id), 0);
+    int next = stationManager.GetStation(sID)->front();
+    if (next >= 0 && minerManager.GetStates()[next] == Miner::WAITING)
+        schedule(next, tick + 1);
+}
+
+/**
+ * @brief Adds a searching miner to the shortest station queue and sets its queue status.
+ *
+ * After finding the shortest wait time at a queue, it either heads directly to the station to unload
+ * or it enters a waiting state until the station is open for them.
+ *
+ * @param id Unique identifier of the miner.
+ * @param worker Index of the pool worker handling the miner.
+ */
+void TickHandler::enqueue(int id, unsigned int worker)
+{
+    auto targetStation = stationManager.GetStation(stationManager.AddToShortestQueue(id));
+
+    if (targetStation && targetStation->isEmpty())
+        minerManager.SetQueueStatus(id, Miner::FRONT);
+    else
+        minerManager.SetQueueStatus(id, Miner::QUEUED);
+    minerManager.SetStation(id, targetStation->GetID());
+    if (log_)
+        log_->Record(worker, {currentTick_, id, targetStation->GetID(), EventLog::ENQUEUE, 0, static_cast<int32_t>(targetStation->size()), 0.0});
+}
+
+/**
+ * @brief Records the station metrics for a finished unload and removes the miner from its station queue.
+ * @param id Unique identifier of the miner.
+ * @param miner The miner, holding the cycle it delivers.
+ * @param worker Index of the pool worker handling the miner.
+ * @return int ID of the station the miner left.
+ */
+int TickHandler::dequeue(int id, const Miner &miner, unsigned int worker)
+{
+    int sID = minerManager.GetStationID(id);
+    auto station = stationManager.GetStation(sID);
+
+    if (log_)
+        log_->Record(worker, {currentTick_, id, sID, EventLog::UNLOAD, miner.GetMiningTime(), static_cast<int32_t>(station->size()), miner.GetLoad()});
+    StationMetrics(*station, sID, miner.GetLoad());
+    stationManager.PopStationQueue(sID);
+    return sID;
+}
+
+/**
+ * @brief Writes the event log header and logs the cycle of every miner mining at the first tick.
+ * A cycle in progress is logged at the tick it started, as far as the miner's countdown tells.
+ */
+void TickHandler::logBegin()
+{
+    vector<uint64_t> minerCounters, stationCounters;
+    for (const auto &stream : minerStreams_)
+        minerCounters.push_back(stream.GetCounter());
+    for (const auto &stream : stationStreams_)
+        stationCounters.push_back(stream.GetCounter());
+    log_->Begin(minerManager.GetSeed(), nextTick_, minerCounters, stationCounters);
+
+    const int *states = minerManager.GetStates();
+    for (int id = 0; id < minerManager.GetAssets(); id++)
+    {
+        if (states[id] != Miner::MINING)
+            continue;
+        Miner miner = minerManager.GetMiner(id);
+        log_->Record(0, {nextTick_ - (miner.GetMiningTime() - miner.GetTime()), id, -1, EventLog::START_MINING, miner.GetMiningTime(), 0, miner.GetLoad()});
+    }
+}
+
+/**
+ * @brief Logs the start of a mining cycle for a miner that has just left its station.
+ * @param id Unique identifier of the miner, ignored unless it is now mining.
+ * @param worker Index of the pool worker handling the miner.
+ */
+void TickHandler::logMiningStart(int id, unsigned int worker)
+{
+    if (minerManager.GetStates()[id] != Miner::MINING)
+        return;
+    Miner miner = minerManager.GetMiner(id);
+    log_->Record(worker, {currentTick_, id, -1, EventLog::START_MINING, miner.GetMiningTime(), 0, miner.GetLoad()});
+}
+
+/**
+ * @brief Records performance metrics for a miner. Left to the replay of the unload event while an event log is attached.
  * @param miner Reference to the miner object.
  * @param id Identifier of the miner.
  */
 void TickHandler::MinierMetrics(Miner &miner, int id)
 {
-    MetricsHandler &metricsHandler = MetricsHandler::GetInstance();
-    string asset = "Miner-" + to_string(id + 1);
+    if (log_)
+        return;
+    int asset = minerAssets_[id];
+    chrono::steady_clock::time_point start;
+    if (profiler_)
+        start = chrono::steady_clock::now();
 
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_real_distribution<double> fuelConsumptionDistr(0.0, 0.02);
-    double ranFuelConsumption = fuelConsumptionDistr(gen);
+    double ranFuelConsumption = minerStreams_[id].Uniform(0.0, 0.02);
     
-    metricsHandler.RecordMetric(asset, "DistanceTraveled", 1.0);
-    metricsHandler.RecordMetric(asset, "LoadCapacityUtilized", miner.GetLoad());
-    metricsHandler.RecordMetric(asset, "FuelConsumption", ranFuelConsumption);
-    metricsHandler.RecordMetric(asset, "MiningTime", miner.GetMiningTime());
+    metricsHandler.RecordMetric(asset, metricIds_[DISTANCE_TRAVELED], 1.0, currentTick_);
+    metricsHandler.RecordMetric(asset, metricIds_[LOAD_CAPACITY_UTILIZED], miner.GetLoad(), currentTick_);
+    metricsHandler.RecordMetric(asset, metricIds_[FUEL_CONSUMPTION], ranFuelConsumption, currentTick_);
+    metricsHandler.RecordMetric(asset, metricIds_[MINING_TIME], miner.GetMiningTime(), currentTick_);
+
+    if (profiler_)
+        TickProfiler::metricsTime += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
 }
 
 /**
- * @brief Records performance metrics for a station.
+ * @brief Records performance metrics for a station. Left to the replay of the unload event while an event log is attached.
  * @param station Reference to the station object.
  * @param id Identifier of the station.
  */
 void TickHandler::StationMetrics(Station &station, int id, double load)
 {
-    MetricsHandler &metricsHandler = MetricsHandler::GetInstance();
-    string asset = "Station-" + to_string(id + 1);
+    if (live_)
+        live_->RecordUnload(id);
+    if (log_)
+        return;
+    int asset = stationAssets_[id];
+    chrono::steady_clock::time_point start;
+    if (profiler_)
+        start = chrono::steady_clock::now();
 
-    metricsHandler.RecordMetric(asset, "QueueTimes", static_cast<double>(station.size()));
+    metricsHandler.RecordMetric(asset, metricIds_[QUEUE_TIMES], static_cast<double>(station.size()), currentTick_);
 
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_real_distribution<double> materialQuality(0.75, 1.0);
-    double raMaterialQuality = materialQuality(gen);
+    double raMaterialQuality = stationStreams_[id].Uniform(0.75, 1.0);
 
-    metricsHandler.RecordMetric(asset, "MaterialVolume", load);
-    metricsHandler.RecordMetric(asset, "MaterialQuality", raMaterialQuality);
-    metricsHandler.RecordMetric(asset, "UtilizationRate", 1);
-    
+    metricsHandler.RecordMetric(asset, metricIds_[MATERIAL_VOLUME], load, currentTick_);
+    metricsHandler.RecordMetric(asset, metricIds_[MATERIAL_QUALITY], raMaterialQuality, currentTick_);
+    metricsHandler.RecordMetric(asset, metricIds_[UTILIZATION_RATE], 1, currentTick_);
+
+    if (profiler_)
+        TickProfiler::metricsTime += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
 }
\ No newline at end of file
@@ -0,0 +1,205 @@
+/**
+ * @file tickprofiler.cpp
+ * @brief Implementation of TickProfiler, per-phase timing of the simulation's ticks.
+ *
+ * Every worker thread appends the phases it ran to its own log, so recording takes no lock.
+ * Per-phase totals and maxima are kept for the whole run, while individual events are kept
+ * up to a fixed budget and exported as a Chrome trace that about://tracing and Perfetto open.
+ * Ticks that run past their interval are counted as overruns, and drift is how far the start
+ * of the latest tick lags behind the schedule set by the interval.
+ */
+
+#include "../inlcude/utils/tickprofiler.h"
+#include "../inlcude/utils/metricshandler.h"
+#include <algorithm>
+
+using namespace std;
+
+thread_local int64_t TickProfiler::metricsTime = 0;
+
+namespace
+{
+    // Indexed by TickProfiler::PHASE
+    const char *const PHASE_NAMES[] = {"Tick", "Stations", "Miners", "Metrics", "Sleep"};
+}
+
+/**
+ * @brief Constructs a profiler.
+ * @param threads Number of threads recording, indexed like the worker pool. Thread 0 also drives the ticks.
+ */
+TickProfiler::TickProfiler(unsigned int threads)
+    : origin(Clock::now()), eventLimit(TRACE_EVENT_LIMIT / max(1u, threads)), logs(max(1u, threads)), overruns(0), longestOverrun(0), drift(0)
+{
+}
+
+/**
+ * @brief Records one phase run by a thread.
+ * @param thread Index of the recording thread.
+ * @param phase One of PHASE.
+ * @param tick Tick the phase belongs to.
+ * @param begin Start of the phase.
+ * @param end End of the phase.
+ * @param detail Metrics time of a STATIONS phase, in nanoseconds.
+ */
+void TickProfiler::Record(unsigned int thread, int phase, int tick, Clock::time_point begin, Clock::time_point end, int64_t detail)
+{
+    ThreadLog &log = logs[thread];
+    int64_t duration = chrono::duration_cast<chrono::nanoseconds>(end - begin).count();
+    log.total[phase] += duration;
+    log.longest[phase] = max(log.longest[phase], duration);
+    log.count[phase]++;
+    if (phase == STATIONS && detail > 0)
+    {
+        log.total[METRICS] += detail;
+        log.longest[METRICS] = max(log.longest[METRICS], detail);
+        log.count[METRICS]++;
+    }
+    if (log.events.size() < eventLimit)
+        log.events.push_back({chrono::duration_cast<chrono::nanoseconds>(begin - origin).count(), duration, detail, tick, phase});
+}
+
+/**
+ * @brief Records a whole tick on the timer thread and checks it against its interval.
+ * @param tick The tick.
+ * @param begin Start of the tick.
+ * @param end End of the tick's work, before any sleep.
+ * @param scheduled When the tick was due to start, following the interval from the first tick.
+ * @param interval_ms Tick interval, 0 for unpaced runs, which never overrun.
+ */
+void TickProfiler::RecordTick(int tick, Clock::time_point begin, Clock::time_point end, Clock::time_point scheduled, unsigned int interval_ms)
+{
+    drift = chrono::duration_cast<chrono::nanoseconds>(begin - scheduled).count();
+    Record(0, TICK, tick, begin, end, drift);
+    int64_t over = chrono::duration_cast<chrono::nanoseconds>(end - begin).count() - static_cast<int64_t>(interval_ms) * 1000000;
+    if (interval_ms > 0 && over > 0)
+    {
+        overruns++;
+        longestOverrun = max(longestOverrun, over);
+    }
+}
+
+/**
+ * @brief Returns how many times a phase ran, across threads.
+ * @param phase One of PHASE.
+ * @return uint64_t Number of recorded phases.
+ */
+uint64_t TickProfiler::GetCount(int phase) const
+{
+    uint64_t count = 0;
+    for (const auto &log : logs)
+        count += log.count[phase];
+    return count;
+}
+
+/**
+ * @brief Returns the time spent in a phase, summed across threads.
+ * @param phase One of PHASE.
+ * @return int64_t Nanoseconds.
+ */
+int64_t TickProfiler::GetTotal(int phase) const
+{
+    int64_t total = 0;
+    for (const auto &log : logs)
+        total += log.total[phase];
+    return total;
+}
+
+/**
+ * @brief Returns the number of ticks whose work took longer than the interval.
+ * @return uint64_t Overruns.
+ */
+uint64_t TickProfiler::GetOverruns() const
+{
+    return overruns;
+}
+
+/**
+ * @brief Lists per-phase and per-thread timings, formatted for console output.
+ */
+void TickProfiler::ListSummary() const
+{
+    cout << "Tick profile: " << GetCount(TICK) << " ticks, " << overruns << " overruns (longest "
+         << longestOverrun / 1e6 << " ms), drift " << drift / 1e6 << " ms" << endl;
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        uint64_t count = GetCount(phase);
+        if (count == 0)
+            continue;
+        int64_t longest = 0;
+        for (const auto &log : logs)
+            longest = max(longest, log.longest[phase]);
+        cout << "  " << PHASE_NAMES[phase]
+             << " - Total: " << GetTotal(phase) / 1e6 << " ms"
+             << ", Average: " << GetTotal(phase) / 1e3 / count << " us"
+             << ", Max: " << longest / 1e3 << " us"
+             << ", Count: " << count << endl;
+    }
+    for (size_t thread = 0; thread < logs.size(); thread++)
+    {
+        const ThreadLog &log = logs[thread];
+        cout << "  Thread " << thread
+             << " - Busy: " << (log.total[STATIONS] + log.total[MINERS]) / 1e6 << " ms"
+             << ", Chunks: " << log.count[MINERS] << endl;
+    }
+}
+
+/**
+ * @brief Exports the kept events as a Chrome trace (JSON), timestamped like the metrics export.
+ * @param filename The filename.
+ */
+void TickProfiler::SaveTrace(const string &filename) const
+{
+    string relativePath = MetricsHandler::TimestampedPath(filename);
+    JsonWriter out(relativePath);
+    if (!out.IsOpen())
+    {
+        cout << "Unable to open file: " << relativePath << endl;
+        return;
+    }
+
+    out.Raw("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    const char *separator = "";
+    for (size_t thread = 0; thread < logs.size(); thread++)
+    {
+        out.Raw(separator);
+        separator = ",";
+        out.Raw("\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": ");
+        out.Unsigned(thread);
+        out.Raw(", \"args\": {\"name\": ");
+        out.String(thread == 0 ? "Timer / Worker 0" : "Worker " + to_string(thread));
+        out.Raw("}}");
+    }
+    for (size_t thread = 0; thread < logs.size(); thread++)
+    {
+        for (const Event &event : logs[thread].events)
+        {
+            out.Raw(",\n{\"name\": ");
+            out.String(PHASE_NAMES[event.phase]);
+            out.Raw(", \"ph\": \"X\", \"pid\": 1, \"tid\": ");
+            out.Unsigned(thread);
+            out.Raw(", \"ts\": ");
+            out.Number(event.begin / 1e3);
+            out.Raw(", \"dur\": ");
+            out.Number(event.duration / 1e3);
+            out.Raw(", \"args\": {\"tick\": ");
+            out.Integer(event.tick);
+            if (event.phase == STATIONS)
+            {
+                out.Raw(", \"metrics_us\": ");
+                out.Number(event.detail / 1e3);
+            }
+            else if (event.phase == TICK)
+            {
+                out.Raw(", \"drift_us\": ");
+                out.Number(event.detail / 1e3);
+            }
+            out.Raw("}}");
+        }
+    }
+    out.Raw("\n]}\n");
+
+    if (out.Flush())
+        cout << "Trace saved to " << relativePath << endl;
+    else
+        cout << "Unable to write file: " << relativePath << endl;
+}
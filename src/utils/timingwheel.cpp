@@ -0,0 +1,73 @@
+/**
+ * @file timingwheel.cpp
+ * @brief Implementation of the TimingWheel class, a calendar queue of per-tick events.
+ *
+ * Events are hashed into a ring of WHEEL_SLOTS buckets by the tick they fire on, so scheduling
+ * and collecting a tick's events cost time proportional to the events involved rather than
+ * to the number of pending events.
+ */
+
+#include "../inlcude/utils/timingwheel.h"
+
+using namespace std;
+
+/**
+ * @brief Constructs an empty wheel.
+ */
+TimingWheel::TimingWheel() : slots(WHEEL_SLOTS), entries(0)
+{
+}
+
+/**
+ * @brief Schedules an event for an ID on a given tick.
+ * @param tick Tick the event fires on.
+ * @param id ID the event belongs to.
+ */
+void TimingWheel::schedule(int tick, int id)
+{
+    slots[tick & (WHEEL_SLOTS - 1)].emplace_back(tick, id);
+    entries++;
+}
+
+/**
+ * @brief Removes every event firing on the given tick and appends their IDs in ascending order.
+ * @param tick Tick being processed.
+ * @param due Receives the IDs of the events that fired.
+ */
+void TimingWheel::popDue(int tick, vector<int> &due)
+{
+    auto &slot = slots[tick & (WHEEL_SLOTS - 1)];
+    size_t first = due.size();
+    size_t kept = 0;
+    for (size_t i = 0; i < slot.size(); i++)
+    {
+        if (slot[i].first == tick)
+            due.push_back(slot[i].second);
+        else
+            slot[kept++] = slot[i];
+    }
+    entries -= slot.size() - kept;
+    slot.resize(kept);
+    sort(due.begin() + first, due.end());
+}
+
+/**
+ * @brief Returns the number of pending events.
+ * @return size_t Pending events, including ones that were superseded by their owner.
+ */
+size_t TimingWheel::size() const
+{
+    return entries;
+}
+
+/**
+ * @brief Drops every pending event.
+ */
+void TimingWheel::clear()
+{
+    for (auto &slot : slots)
+    {
+        slot.clear();
+    }
+    entries = 0;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file workerpool.cpp
+ * @brief Implementation of the WorkerPool class, a fixed-size work-stealing thread pool.
+ *
+ * A parallelFor call splits an index range into chunks and deals contiguous runs of chunks
+ * to each worker's own queue. Workers drain their queue from the front and, once empty,
+ * steal from the back of other workers' queues, which balances uneven per-chunk cost.
+ * The calling thread takes part as worker 0, so a pool of one worker runs entirely inline.
+ */
+
+#include "../inlcude/utils/workerpool.h"
+
+using namespace std;
+
+/**
+ * @brief Constructs the pool and launches its worker threads.
+ * @param workers Number of workers, including the calling thread. 0 sizes the pool to the hardware.
+ */
+WorkerPool::WorkerPool(unsigned int workers) : workers(workers), task(nullptr), pending(0), generation(0), shutdown(false)
+{
+    if (this->workers == 0)
+    {
+        this->workers = max(1u, thread::hardware_concurrency());
+    }
+
+    for (unsigned int i = 0; i < this->workers; i++)
+    {
+        queues.emplace_back(make_unique<ChunkQueue>());
+    }
+
+    // Worker 0 is whichever thread calls parallelFor
+    for (unsigned int i = 1; i < this->workers; i++)
+    {
+        threads.emplace_back([this, i]()
+                             { this->workerLoop(i); });
+    }
+}
+
+/**
+ * @brief Signals every worker to exit and joins them.
+ */
+WorkerPool::~WorkerPool()
+{
+    {
+        lock_guard<mutex> lock(poolMtx);
+        shutdown = true;
+    }
+    wakeCv.notify_all();
+    for (auto &thread : threads)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+}
+
+/**
+ * @brief Runs a task over [begin, end) in chunks of at most grain indices and blocks until every chunk is done.
+ * @param begin First index of the range.
+ * @param end One past the last index of the range.
+ * @param grain Maximum number of indices per chunk.
+ * @param task Callable invoked once per chunk.
+ */
+void WorkerPool::parallelFor(int begin, int end, int grain, const Task &task)
+{
+    if (end <= begin)
+        return;
+
+    grain = max(1, grain);
+    int chunkCount = (end - begin + grain - 1) / grain;
+
+    {
+        lock_guard<mutex> lock(poolMtx);
+        this->task = &task;
+        pending = chunkCount;
+
+        // Deal contiguous runs of chunks so each worker keeps touching the same miners from tick to tick
+        for (unsigned int w = 0; w < workers; w++)
+        {
+            int first = static_cast<int>(static_cast<long long>(chunkCount) * w / workers);
+            int last = static_cast<int>(static_cast<long long>(chunkCount) * (w + 1) / workers);
+            lock_guard<mutex> queueLock(queues[w]->mtx);
+            for (int c = first; c < last; c++)
+            {
+                int chunkBegin = begin + c * grain;
+                queues[w]->chunks.emplace_back(chunkBegin, min(end, chunkBegin + grain));
+            }
+        }
+        generation++;
+    }
+    wakeCv.notify_all();
+
+    drain(0);
+
+    unique_lock<mutex> lock(poolMtx);
+    doneCv.wait(lock, [this]()
+                { return pending == 0; });
+    this->task = nullptr;
+}
+
+/**
+ * @brief Returns the number of workers in the pool, including the calling thread.
+ * @return unsigned int Worker count.
+ */
+unsigned int WorkerPool::GetWorkers() const
+{
+    return workers;
+}
+
+/**
+ * @brief Main loop of a pool thread: sleeps until a new parallelFor is published, then drains chunks.
+ * @param worker Index of this worker.
+ */
+void WorkerPool::workerLoop(unsigned int worker)
+{
+    unsigned long long seen = 0;
+    while (true)
+    {
+        {
+            unique_lock<mutex> lock(poolMtx);
+            wakeCv.wait(lock, [this, seen]()
+                        { return shutdown || generation != seen; });
+            if (shutdown)
+                return;
+            seen = generation;
+        }
+        drain(worker);
+    }
+}
+
+/**
+ * @brief Executes chunks from the worker's own queue, then steals until no work is left anywhere.
+ * @param worker Index of the draining worker.
+ */
+void WorkerPool::drain(unsigned int worker)
+{
+    pair<int, int> chunk;
+    while (popLocal(worker, chunk) || steal(worker, chunk))
+    {
+        // Chunks are only published after task is set, and the queue mutex orders the two
+        (*task)(chunk.first, chunk.second, worker);
+        if (--pending == 0)
+        {
+            lock_guard<mutex> lock(poolMtx);
+            doneCv.notify_all();
+        }
+    }
+}
+
+/**
+ * @brief Takes the next chunk from the front of the worker's own queue.
+ * @return true If a chunk was taken.
+ */
+bool WorkerPool::popLocal(unsigned int worker, pair<int, int> &chunk)
+{
+    ChunkQueue &queue = *queues[worker];
+    lock_guard<mutex> lock(queue.mtx);
+    if (queue.chunks.empty())
+        return false;
+    chunk = queue.chunks.front();
+    queue.chunks.pop_front();
+    return true;
+}
+
+/**
+ * @brief Steals a chunk from the back of another worker's queue, visiting victims round-robin.
+ * @return true If a chunk was stolen.
+ */
+bool WorkerPool::steal(unsigned int worker, pair<int, int> &chunk)
+{
+    for (unsigned int i = 1; i < workers; i++)
+    {
+        ChunkQueue &victim = *queues[(worker + i) % workers];
+        lock_guard<mutex> lock(victim.mtx);
+        if (!victim.chunks.empty())
+        {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}